@@ -2,7 +2,6 @@
 #include <string.h> // Adicionado para memset
 #include <stdlib.h> // Para funções de memória, embora o driver OLED já gerencie
 #include <ctype.h>  // Para isalnum etc., se usado em alguma função de texto
-#include <math.h>   // Para fminf na normalização RGB
 
 #include "pico/stdlib.h"
 #include "pico/binary_info.h"
@@ -12,8 +11,12 @@
 
 // --- Inclusões dos Drivers e Módulos ---
 #include "tcs34725.h"          // Driver do sensor de cor TCS34725
+#include "controle_exposicao.h" // Ganho e tempo de integração automáticos (AGC/AEC)
+#include "filtro_amostras.h"    // Suavização incremental das leituras do sensor
 #include "identificador_cor.h" // Módulo de identificação de cor
+#include "tabelas_cores.h"     // Paleta gerada no build (paleta_cores.csv)
 #include "filtros_daltonismo.h"
+#include "escalonador.h"       // Tarefas periódicas do Core 0
 #include "config.h"
 
 // Inclusões para o OLED (baseadas nos arquivos ssd1306.h e ssd1306_i2c.h fornecidos)
@@ -21,8 +24,10 @@
 #include "inc/ssd1306_i2c.h" // Contém as definições globais como ssd1306_buffer e ssd1306_buffer_length
 
 #include "pico/multicore.h" // Para multicore_launch_core1
-#include "pico/sync.h"      // Para mutex_t
 #include "shared_data.h"
+#ifdef COLORVIZ_BANCADA
+#include "bancada.h"
+#endif
 
 extern uint8_t ssd1306_buffer[]; // Declaração do buffer global do driver OLED
 
@@ -34,31 +39,52 @@ struct render_area frame_area = {
     end_page : ssd1306_n_pages - 1
 };
 
-volatile absolute_time_t ultimo_clique_joystick = {0};
-
 // --- Declarações de Funções Auxiliares (que permanecem no main.c) ---
-void normalizar_rgb(uint16_t r_bruto, uint16_t g_bruto, uint16_t b_bruto,
-                    uint8_t *r_normalizado, uint8_t *g_normalizado, uint8_t *b_normalizado);
 int ler_adc(uint gpio_pin);
 void limpar_oled();
 void desenhar_menu_daltonismo();
-void leitura_media_cor(uint8_t *r_out, uint8_t *g_out, uint8_t *b_out);
-void desenhar_tela_analise(const char *tipo_daltonismo, const char *nome_cor, uint8_t r, uint8_t g, uint8_t b);
-
-void normalizar_rgb(uint16_t r_bruto, uint16_t g_bruto, uint16_t b_bruto,
-                    uint8_t *r_normalizado, uint8_t *g_normalizado, uint8_t *b_normalizado)
-{
-
-    float max_bruto_base = 500.0f; // Valor de referência máximo do sensor para um ambiente específico
-
-    // Ajuste do fator de luz para escalar o valor máximo bruto baseado na luminosidade atual
-    float max_bruto_para_ambiente_atual = 100.0f;
-
-    // Normaliza cada canal para o intervalo 0-255, garantindo que não exceda 255
-    *r_normalizado = (uint8_t)fminf(255.0f, (r_bruto / max_bruto_para_ambiente_atual) * 255.0f);
-    *g_normalizado = (uint8_t)fminf(255.0f, (g_bruto / max_bruto_para_ambiente_atual) * 255.0f);
-    *b_normalizado = (uint8_t)fminf(255.0f, (b_bruto / max_bruto_para_ambiente_atual) * 255.0f);
-}
+bool leitura_cor_filtrada(uint8_t *r_out, uint8_t *g_out, uint8_t *b_out);
+void desenhar_tela_analise(const char *tipo_daltonismo, const char *nome_cor, const char *alternativa,
+                           uint8_t r, uint8_t g, uint8_t b, const uint8_t *daltonizado);
+
+// Candidatas pedidas ao identificador a cada amostra (a primeira e as alternativas).
+#define CANDIDATAS_IDENTIFICACAO 3
+
+// O que está desenhado na tela de análise. A tela só é redesenhada quando muda;
+// TELA_ANALISE_INVALIDA força o próximo desenho (ex.: depois do menu).
+#define TELA_ANALISE_INVALIDA UINT64_MAX
+// Item do menu depois dos tipos de daltonismo: ajuste da severidade
+#define OPCAO_MENU_SEVERIDADE NUM_OPCOES_MENU
+static uint64_t tela_analise_desenhada = TELA_ANALISE_INVALIDA;
+
+// --- Tarefas do Core 0 (escalonador.h) ---
+// Períodos em microssegundos. A aquisição acompanha o tempo de integração do sensor
+// (ver periodo_aquisicao_us()); as outras têm período fixo.
+#define PERIODO_PROCESSAMENTO_US 10000
+#define PERIODO_ENTRADA_US 20000
+#define PERIODO_TELA_US 50000
+#define PERIODO_LOG_US 1000000
+// A cada quantos logs o relatório do escalonador é impresso
+#define LOGS_POR_RELATORIO 10
+// Com o joystick parado num dos lados, o menu anda uma opção a cada intervalo destes
+#define MENU_REPETICAO_US 250000
+
+static int tarefa_aquisicao = -1;
+
+// Da aquisição para o processamento: a última amostra normalizada do sensor
+static uint8_t rgb_sensor[3];
+static bool amostra_nova = false;
+
+// Do processamento para a tela e o log: o resultado da última amostra
+static bool resultado_valido = false;
+static int severidade_aplicada;
+static identificacao_cor_t identificacao_atual;
+static uint8_t rgb_ideal[3]; // RGB ideal da cor identificada, que é o filtrado
+static uint8_t rgb_modos_atual[DALTONISMO_NUM_TIPOS + 1][3];
+static uint8_t rgb_daltonizado_atual[DALTONISMO_NUM_TIPOS + 1][3];
+
+// O menu precisa ser redesenhado (mudou a opção, a severidade ou a tela)
+static bool menu_sujo = true;
 
 /**
  * @brief Lê o valor de um pino ADC específico.
@@ -72,37 +98,19 @@ int ler_adc(uint gpio_pin)
 }
 
 /**
- * @brief Verifica se o botão de clique central do joystick (GPIO22) foi pressionado, com debounce.
- * @return true se o botão foi pressionado, false caso contrário.
+ * @brief Severidade pedida (menu ou web), em décimos.
  */
-bool joystick_botao_pressionado()
+int severidade_atual()
 {
-    // Para debounce, verificamos se passou tempo suficiente desde o último evento
-    if (absolute_time_diff_us(get_absolute_time(), ultimo_clique_joystick) < DEBOUNCE_MS * 1000)
-    {
-        return false;
-    }
-    // Se o botão está pressionado (pino LOW, assumindo pull-up)
-    if (gpio_get(JOYSTICK_SW_PIN) == 0)
-    {
-        ultimo_clique_joystick = get_absolute_time(); // Atualiza o último tempo de clique
-        return true;
-    }
-    return false;
+    return shared_severidade;
 }
 
 /**
- * @brief Verifica o movimento do joystick no eixo Y (para cima/baixo), com debounce.
- * @return -1 para "cima", 1 para "baixo", 0 para "nenhum movimento significativo".
+ * @brief Muda a severidade pedida; o Core 0 a aplica no próximo quadro.
  */
-int joystick_eixo_y()
+void definir_severidade(int severidade)
 {
-    uint16_t val = ler_adc(JOYSTICK_VRY_PIN);
-    if (val < 500)
-        return -1;
-    else if (val > 3500)
-        return 1;
-    return 0;
+    shared_severidade = severidade;
 }
 
 /**
@@ -120,6 +128,12 @@ void desenhar_menu_daltonismo()
         sprintf(buffer, "%s %s", (i == opcao_selecionada_menu ? "--" : " "), menu_opcoes[i]);
         ssd1306_draw_string(ssd1306_buffer, 0, 10 + (i * 8), buffer);
     }
+
+    // Última linha: severidade (o clique avança 10%)
+    char buffer[30];
+    sprintf(buffer, "%s Severidade %d%%", (opcao_selecionada_menu == OPCAO_MENU_SEVERIDADE ? "--" : " "),
+            severidade_atual() * 100 / DALTONISMO_SEVERIDADE_MAX);
+    ssd1306_draw_string(ssd1306_buffer, 0, 10 + (NUM_OPCOES_MENU * 8), buffer);
     ssd1306_send_buffer(ssd1306_buffer, ssd1306_buffer_length);
 }
 
@@ -127,11 +141,14 @@ void desenhar_menu_daltonismo()
  * @brief Desenha a tela de análise de cor na tela OLED.
  * @param tipo_daltonismo String que descreve o modo de daltonismo.
  * @param nome_cor String com o nome da cor identificada.
+ * @param alternativa Segunda candidata quando a identificação é ambígua, ou NULL.
  * @param r Valor do canal vermelho (0-255).
  * @param g Valor do canal verde (0-255).
  * @param b Valor do canal azul (0-255).
+ * @param daltonizado Cor corrigida (daltonização) para o modo, ou NULL.
  */
-void desenhar_tela_analise(const char *tipo_daltonismo, const char *nome_cor, uint8_t r, uint8_t g, uint8_t b)
+void desenhar_tela_analise(const char *tipo_daltonismo, const char *nome_cor, const char *alternativa,
+                           uint8_t r, uint8_t g, uint8_t b, const uint8_t *daltonizado)
 {
     limpar_oled(); // Limpa o buffer do OLED
 
@@ -145,178 +162,343 @@ void desenhar_tela_analise(const char *tipo_daltonismo, const char *nome_cor, ui
     sprintf(buffer, "%s", nome_cor);
     ssd1306_draw_string(ssd1306_buffer, 0, 16, buffer); 
 
+    // Identificação ambígua: mostra a outra cor provável
+    if (alternativa != NULL)
+    {
+        snprintf(buffer, sizeof(buffer), "ou %s", alternativa);
+        ssd1306_draw_string(ssd1306_buffer, 0, 24, buffer);
+    }
+
     // Valores RGB Transformados (Hexadecimal)
     // Usar "%02X" para formatar como hexadecimal com 2 dígitos e preenchimento com zero
     sprintf(buffer, "HEX: #%02X%02X%02X", r, g, b);     
     ssd1306_draw_string(ssd1306_buffer, 0, 32, buffer); 
 
+    // Sugestão de cor corrigida, que continua distinguível para o modo
+    if (daltonizado != NULL)
+    {
+        snprintf(buffer, sizeof(buffer), "CORR: #%02X%02X%02X", daltonizado[0], daltonizado[1], daltonizado[2]);
+        ssd1306_draw_string(ssd1306_buffer, 0, 40, buffer);
+    }
+
     ssd1306_draw_string(ssd1306_buffer, 0, 56, "Voltar: btn 5");
     ssd1306_send_buffer(ssd1306_buffer, ssd1306_buffer_length);
 }
 
-void leitura_media_cor(uint8_t *r_out, uint8_t *g_out, uint8_t *b_out)
+/**
+ * @brief Desenha a tela de análise só se o conteúdo mudou desde o último desenho.
+ *
+ * O conteúdo depende do modo, da severidade, da cor identificada e da alternativa
+ * (quando ambígua); enquanto a identidade estiver estável, o OLED não é reenviado.
+ */
+void atualizar_tela_analise(int severidade, const identificacao_cor_t *identificacao,
+                            uint8_t r, uint8_t g, uint8_t b, const uint8_t daltonizado[3])
+{
+    uint16_t indice = identificacao->candidatas[0].indice;
+    uint32_t alternativa = identificacao->ambigua ? identificacao->candidatas[1].indice + 1u : 0;
+    uint64_t conteudo = ((uint64_t)severidade << 56) | ((uint64_t)opcao_selecionada_menu << 48) |
+                        ((uint64_t)alternativa << 16) | indice;
+    if (conteudo == tela_analise_desenhada)
+    {
+        return;
+    }
+    tela_analise_desenhada = conteudo;
+
+    char titulo[24];
+    snprintf(titulo, sizeof(titulo), "%s %d%%",
+             nome_daltonismo((tipo_daltonismo_t)opcao_selecionada_menu, severidade),
+             severidade * 100 / DALTONISMO_SEVERIDADE_MAX);
+    desenhar_tela_analise(titulo, tabelas_cores_nome(indice),
+                          alternativa ? tabelas_cores_nome(alternativa - 1) : NULL, r, g, b, daltonizado);
+}
+
+/**
+ * @brief Publica o resultado para o servidor web (Core 1).
+ * @param rgb_modos Cor em todos os modos (simular_todos_daltonismos()).
+ * @param rgb_daltonizado Cor corrigida de cada modo, na mesma numeração.
+ * @param modo Modo escolhido no aparelho: 0=Normal, ou 1 + o tipo_daltonismo_t.
+ * @param severidade Severidade aplicada, em décimos.
+ */
+void publicar_resultado(const uint8_t rgb_modos[DALTONISMO_NUM_TIPOS + 1][3],
+                        const uint8_t rgb_daltonizado[DALTONISMO_NUM_TIPOS + 1][3], int modo, int severidade,
+                        const identificacao_cor_t *identificacao)
+{
+    // Identidade: cor, alternativas, ambiguidade, modo e severidade. A confiança oscila
+    // com o ruído e fica de fora.
+    static uint64_t identidade_publicada = UINT64_MAX;
+    uint64_t identidade = ((uint64_t)modo << 60) | ((uint64_t)severidade << 56) |
+                          ((uint64_t)identificacao->ambigua << 55) |
+                          ((uint64_t)identificacao->quantidade << 52);
+    for (int i = 0; i < identificacao->quantidade && i < CANDIDATAS_IDENTIFICACAO; i++)
+    {
+        identidade |= (uint64_t)identificacao->candidatas[i].indice << (16 * i);
+    }
+    static uint32_t versao_identidade = 0;
+    if (identidade != identidade_publicada)
+    {
+        identidade_publicada = identidade;
+        versao_identidade++;
+    }
+
+    snapshot_cor_t snapshot;
+    memset(&snapshot, 0, sizeof(snapshot));
+    snapshot.modo = modo;
+    snapshot.severidade = severidade;
+    memcpy(snapshot.rgb_modos, rgb_modos, sizeof(snapshot.rgb_modos));
+    memcpy(snapshot.rgb_daltonizado, rgb_daltonizado, sizeof(snapshot.rgb_daltonizado));
+    memcpy(&snapshot.identificacao, identificacao, sizeof(snapshot.identificacao));
+    snapshot.versao_identidade = versao_identidade;
+    anel_amostras_publicar(&snapshot); // Nunca bloqueia: com o anel cheio, a amostra é contada como perdida
+}
+
+/**
+ * @brief Lê a conversão nova do sensor, se já houver uma, e a suaviza e normaliza.
+ * @return true se uma amostra nova foi gravada em r_out, g_out e b_out.
+ */
+bool leitura_cor_filtrada(uint8_t *r_out, uint8_t *g_out, uint8_t *b_out)
 {
     // Variável local para armazenar os dados brutos de uma única leitura do sensor TCS34725.
     // 'tcs34725_color_data_t' é uma estrutura definida pelo driver 'tcs34725.h'.
     tcs34725_color_data_t dados_sensor_brutos;
 
-    uint32_t acumulador_red_leitura = 0;
-    uint32_t acumulador_green_leitura = 0;
-    uint32_t acumulador_blue_leitura = 0;
-    // Realiza a leitura do sensor TCS34725.
-    for (int i = 0; i < NUM_LEITURAS_MEDIA; i++)
+    // Histórico das leituras: cada conversão nova gera uma saída suavizada.
+    static filtro_amostras_t filtro_cor;
+    static bool filtro_iniciado = false;
+
+    if (!filtro_iniciado)
     {
-        // Realiza uma única leitura do sensor TCS34725.
-        tcs34725_read_colors(I2C_PORT_COR, &dados_sensor_brutos);
-        // Acumula os valores brutos de cada leitura nos acumuladores globais.
-        acumulador_red_leitura += dados_sensor_brutos.red;
-        acumulador_green_leitura += dados_sensor_brutos.green;
-        acumulador_blue_leitura += dados_sensor_brutos.blue;
-
-        sleep_ms(10);
+        filtro_amostras_init(&filtro_cor, FILTRO_COR_MODO, FILTRO_COR_JANELA, FILTRO_COR_ALFA_Q8);
+        filtro_iniciado = true;
     }
 
-    uint32_t red_media = acumulador_red_leitura / NUM_LEITURAS_MEDIA;
-    uint32_t green_media = acumulador_green_leitura / NUM_LEITURAS_MEDIA;
-    uint32_t blue_media = acumulador_blue_leitura / NUM_LEITURAS_MEDIA;
+    // Sem esperar: cada leitura é uma conversão nova, nunca a mesma repetida.
+    if (!tcs34725_read_colors_if_ready(I2C_PORT_COR, &dados_sensor_brutos))
+    {
+        return false;
+    }
+    uint16_t amostra[FILTRO_CANAIS] = {
+        dados_sensor_brutos.clear,
+        dados_sensor_brutos.red,
+        dados_sensor_brutos.green,
+        dados_sensor_brutos.blue,
+    };
+    uint16_t suavizado[FILTRO_CANAIS];
+    filtro_amostras_processar(&filtro_cor, amostra, suavizado);
+
+    // AGC/AEC com o clear instantâneo, para reagir já na próxima conversão.
+    // As amostras antigas foram medidas com outra exposição e saem do histórico.
+    if (controle_exposicao_atualizar(dados_sensor_brutos.clear))
+    {
+        exposicao_t exposicao = controle_exposicao_atual();
+        tcs34725_set_config(I2C_PORT_COR, exposicao.atime, exposicao.ganho);
+        filtro_amostras_reiniciar(&filtro_cor);
+    }
 
     // --- Normalizar e Armazenar Resultados ---
-    // Chama a função 'normalizar_rgb' (sua versão), passando as médias calculadas.
     // 'r_out', 'g_out', 'b_out' são ponteiros para onde os valores normalizados (0-255) serão gravados.
-    // É importante passar r_out, g_out, b_out DIRETAMENTE aqui, pois eles JÁ SÃO ponteiros.
-    normalizar_rgb(red_media, green_media, blue_media, r_out, g_out, b_out);
+    // Relativos ao clear da mesma amostra: não dependem da exposição nem da luz ambiente.
+    controle_exposicao_normalizar_rgb(suavizado[1], suavizado[2], suavizado[3], suavizado[0], r_out, g_out, b_out);
+    return true;
 }
 
-int main()
+// Poll do sensor algumas vezes por integração: a amostra sai logo depois da conversão,
+// e a tarefa volta na hora enquanto ela não terminou.
+static uint32_t periodo_aquisicao_us(void)
 {
-    iniciar_sistema(); // Inicializa todos os componentes
-    mutex_init(&shared_data_mutex);
-    multicore_launch_core1(core1_entry);
-    printf("Core 1 lançado com a função core1_entry().\n");
-
-    desenhar_menu_daltonismo(); // Desenha o menu inicial no display OLED uma vez
+    uint32_t periodo = tcs34725_integration_time_us(controle_exposicao_atual().atime) / 4;
+    return periodo > 1000 ? periodo : 1000;
+}
 
-    while (1) // Loop principal do programa
+/**
+ * @brief Tarefa de aquisição: lê e suaviza a conversão nova do sensor, se houver.
+ */
+static void tarefa_aquisicao_executar(void)
+{
+    if (leitura_cor_filtrada(&rgb_sensor[0], &rgb_sensor[1], &rgb_sensor[2]))
     {
+        amostra_nova = true;
+    }
+    // A exposição pode ter mudado com esta amostra
+    escalonador_definir_periodo(tarefa_aquisicao, periodo_aquisicao_us());
+}
 
-        uint8_t r_norm, g_norm, b_norm;
-        leitura_media_cor(&r_norm, &g_norm, &b_norm);
+/**
+ * @brief Tarefa de processamento: identifica a amostra nova, simula e corrige
+ * todos os modos e publica o resultado para o Core 1.
+ */
+static void tarefa_processamento_executar(void)
+{
+    if (!amostra_nova)
+    {
+        return;
+    }
+    amostra_nova = false;
+
+    // Uma busca devolve a cor, as alternativas e a confiança, sem alterar a amostra.
+    identificar_cor_candidatas(rgb_sensor[0], rgb_sensor[1], rgb_sensor[2], CANDIDATAS_IDENTIFICACAO,
+                               &identificacao_atual);
+    uint16_t indice_cor = identificacao_atual.candidatas[0].indice;
+    rgb_ideal[0] = cores_rgb_ideal[indice_cor][0];
+    rgb_ideal[1] = cores_rgb_ideal[indice_cor][1];
+    rgb_ideal[2] = cores_rgb_ideal[indice_cor][2];
+
+    // Todos os modos numa passada e publicados juntos: a web mostra qualquer um
+    // deles sem depender do modo escolhido no joystick.
+    severidade_aplicada = severidade_atual(); // Pode ter mudado pela web
+    simular_todos_daltonismos(severidade_aplicada, rgb_ideal[0], rgb_ideal[1], rgb_ideal[2],
+                              rgb_modos_atual, rgb_daltonizado_atual);
+    resultado_valido = true;
+
+    // 0 = Normal enquanto o menu estiver na tela; senão, o tipo escolhido
+    int modo = estado_atual == ESTADO_ANALISE ? opcao_selecionada_menu + 1 : 0;
+    publicar_resultado(rgb_modos_atual, rgb_daltonizado_atual, modo, severidade_aplicada, &identificacao_atual);
+}
 
-        uint8_t r_corrigido = r_norm; // Estes serão os valores R, G, B que poderão ser filtrados
-        uint8_t g_corrigido = g_norm;
-        uint8_t b_corrigido = b_norm;
-        const char *nome_cor_identificada = identificar_cor(&r_corrigido, &g_corrigido, &b_corrigido);
+/**
+ * @brief Tarefa de entrada: joystick do menu e modo pedido pela web.
+ * O botão 5 (voltar) é tratado pela IRQ.
+ */
+static void tarefa_entrada_executar(void)
+{
+    static bool botao_anterior = false;
+    static bool eixo_solto = true;
+    static uint64_t ultimo_movimento_us = 0;
 
-        printf("\nRGB Normalizada: R:%3u G:%3u B:%3u | ", r_corrigido, g_corrigido, b_corrigido);
-        printf("\nRGB Cor sensor le: R:%3u G:%3u B:%3u | ", r_norm, g_norm, b_norm);
-        
-        switch (estado_atual)
+    // Pedido da web (WebSocket): o mesmo efeito de escolher o tipo no menu ou de voltar
+    int modo_web;
+    if (modo_web_pedido(&modo_web))
+    {
+        if (modo_web == 0)
         {
-        case ESTADO_MENU_DALTONISMO:
+            estado_atual = ESTADO_MENU_DALTONISMO;
+            menu_sujo = true;
+        }
+        else
         {
-            uint16_t val_y = ler_adc(JOYSTICK_VRY_PIN);
-            if (flag)
-            {
-                desenhar_menu_daltonismo();
-                flag = false;
-            }
-            if (val_y < 1000)
-            { // Joystick para cima
-                opcao_selecionada_menu--;
-                if (opcao_selecionada_menu < 0)
-                {
-                    opcao_selecionada_menu = NUM_OPCOES_MENU - 1;
-                }
-                desenhar_menu_daltonismo();
-                sleep_ms(50); // Debounce simples
-            }
-            else if (val_y > 3000)
-            { // Joystick para baixo
-                opcao_selecionada_menu++;
-                if (opcao_selecionada_menu >= NUM_OPCOES_MENU)
-                {
-                    opcao_selecionada_menu = 0;
-                }
-                desenhar_menu_daltonismo();
-                sleep_ms(50); // Debounce simples
-            }
-
-            if (gpio_get(JOYSTICK_SW_PIN) == 0)
-            {                 // Botão do joystick pressionado
-                sleep_ms(50); // Debounce do botão
-                // printf("Opcao selecionada: %s\n", menu_opcoes[opcao_selecionada_menu]);
-                switch (opcao_selecionada_menu)
-                {
-                case 0:
-                    estado_atual = ESTADO_ANALISE_PROTANOPIA;
-                    break;
-                case 1:
-                    estado_atual = ESTADO_ANALISE_DEUTERANOPIA;
-                    break;
-                case 2:
-                    estado_atual = ESTADO_ANALISE_TRITANOPIA;
-                    break;
-                }
-                desenhar_tela_analise(menu_opcoes[opcao_selecionada_menu], nome_cor_identificada, r_corrigido, g_corrigido, b_corrigido);
-            }
-            break;
+            opcao_selecionada_menu = modo_web - 1;
+            estado_atual = ESTADO_ANALISE;
+            tela_analise_desenhada = TELA_ANALISE_INVALIDA;
         }
+    }
+
+    // Borda de descida do clique, amostrado a cada PERIODO_ENTRADA_US (já faz o debounce)
+    bool botao = gpio_get(JOYSTICK_SW_PIN) == 0;
+    bool clique = botao && !botao_anterior;
+    botao_anterior = botao;
+
+    if (estado_atual != ESTADO_MENU_DALTONISMO)
+    {
+        eixo_solto = true;
+        return;
+    }
 
-        case ESTADO_ANALISE_PROTANOPIA:
+    uint16_t val_y = ler_adc(JOYSTICK_VRY_PIN);
+    int passo = val_y < 1000 ? -1 : (val_y > 3000 ? 1 : 0); // Para cima / para baixo
+    uint64_t agora = time_us_64();
+    if (passo == 0)
+    {
+        eixo_solto = true;
+    }
+    else if (eixo_solto || agora - ultimo_movimento_us >= MENU_REPETICAO_US)
+    {
+        eixo_solto = false;
+        ultimo_movimento_us = agora;
+        opcao_selecionada_menu += passo;
+        if (opcao_selecionada_menu < 0)
         {
-            desenhar_tela_analise(menu_opcoes[opcao_selecionada_menu], nome_cor_identificada, r_corrigido, g_corrigido, b_corrigido);
-            aplicar_filtro_protanopia(&r_corrigido, &g_corrigido, &b_corrigido);
-
-            mutex_enter_blocking(&shared_data_mutex);
-            shared_r_corrigido = r_corrigido;
-            shared_g_corrigido = g_corrigido;
-            shared_b_corrigido = b_corrigido;
-            strncpy((char *)shared_color_name, nome_cor_identificada, sizeof(shared_color_name) - 1);
-            ((char *)shared_color_name)[sizeof(shared_color_name) - 1] = '\0';
-            shared_daltonism_mode = 1; // 1 para Protanopia
-            mutex_exit(&shared_data_mutex);
-
-            break;
+            opcao_selecionada_menu = OPCAO_MENU_SEVERIDADE;
         }
-        case ESTADO_ANALISE_DEUTERANOPIA:
+        else if (opcao_selecionada_menu > OPCAO_MENU_SEVERIDADE)
         {
-            desenhar_tela_analise(menu_opcoes[opcao_selecionada_menu], nome_cor_identificada, r_corrigido, g_corrigido, b_corrigido);
-            aplicar_filtro_deuteranopia(&r_corrigido, &g_corrigido, &b_corrigido);
-            
-            mutex_enter_blocking(&shared_data_mutex);
-            shared_r_corrigido = r_corrigido;
-            shared_g_corrigido = g_corrigido;
-            shared_b_corrigido = b_corrigido;
-            strncpy((char *)shared_color_name, nome_cor_identificada, sizeof(shared_color_name) - 1);
-            ((char *)shared_color_name)[sizeof(shared_color_name) - 1] = '\0';
-            shared_daltonism_mode = 2; // 2 para Deuteranopia
-            mutex_exit(&shared_data_mutex);
-
-            break;
+            opcao_selecionada_menu = 0;
         }
-        case ESTADO_ANALISE_TRITANOPIA:
+        menu_sujo = true;
+    }
+
+    if (clique && opcao_selecionada_menu == OPCAO_MENU_SEVERIDADE)
+    { // Clique na severidade: avança 10% (depois de 100%, volta a 0%)
+        definir_severidade((severidade_atual() + 1) % DALTONISMO_NUM_SEVERIDADES);
+        menu_sujo = true;
+    }
+    else if (clique)
+    {
+        estado_atual = ESTADO_ANALISE;
+        tela_analise_desenhada = TELA_ANALISE_INVALIDA;
+    }
+}
+
+/**
+ * @brief Tarefa da tela: redesenha o menu ou a análise quando o conteúdo muda.
+ */
+static void tarefa_tela_executar(void)
+{
+    static int severidade_no_menu = -1;
+
+    if (flag) // Botão 5: voltou ao menu
+    {
+        flag = false;
+        menu_sujo = true;
+    }
+
+    if (estado_atual == ESTADO_MENU_DALTONISMO)
+    {
+        tela_analise_desenhada = TELA_ANALISE_INVALIDA; // O menu ocupa a tela
+        int severidade = severidade_atual(); // Também muda pela web
+        if (menu_sujo || severidade != severidade_no_menu)
         {
-            desenhar_tela_analise(menu_opcoes[opcao_selecionada_menu], nome_cor_identificada, r_corrigido, g_corrigido, b_corrigido);
-            aplicar_filtro_tritanopia(&r_corrigido, &g_corrigido, &b_corrigido);
-           
-            mutex_enter_blocking(&shared_data_mutex);
-            shared_r_corrigido = r_corrigido;
-            shared_g_corrigido = g_corrigido;
-            shared_b_corrigido = b_corrigido;
-            strncpy((char *)shared_color_name, nome_cor_identificada, sizeof(shared_color_name) - 1);
-            ((char *)shared_color_name)[sizeof(shared_color_name) - 1] = '\0';
-            shared_daltonism_mode = 3; // 3 para Tritanopia
-            mutex_exit(&shared_data_mutex);
-
-            break;
-        }
+            desenhar_menu_daltonismo();
+            menu_sujo = false;
+            severidade_no_menu = severidade;
         }
+    }
+    else if (resultado_valido)
+    {
+        menu_sujo = true; // Ao voltar, o menu é desenhado de novo
+        atualizar_tela_analise(severidade_aplicada, &identificacao_atual, rgb_ideal[0], rgb_ideal[1], rgb_ideal[2],
+                               rgb_daltonizado_atual[opcao_selecionada_menu + 1]);
+    }
+}
 
-        // Imprime informações no monitor serial para depuração (ainda útil!)
-        printf("Estado: %s ", (estado_atual == ESTADO_MENU_DALTONISMO ? "MENU" : menu_opcoes[opcao_selecionada_menu]));
-        printf("Cor Identificada: %s\n", nome_cor_identificada);
+/**
+ * @brief Tarefa de log: o último resultado na serial e, de tempos em tempos,
+ * o relatório do escalonador.
+ */
+static void tarefa_log_executar(void)
+{
+    static int logs = 0;
 
-        sleep_ms(50); // Pequeno atraso para não sobrecarregar o loop e a atualização da tela
+    if (resultado_valido)
+    {
+        printf("\nRGB Normalizada: R:%3u G:%3u B:%3u | ", rgb_ideal[0], rgb_ideal[1], rgb_ideal[2]);
+        printf("\nRGB Cor sensor le: R:%3u G:%3u B:%3u | ", rgb_sensor[0], rgb_sensor[1], rgb_sensor[2]);
+        printf("Estado: %s ", (estado_atual == ESTADO_MENU_DALTONISMO ? "MENU" : menu_opcoes[opcao_selecionada_menu]));
+        printf("Cor Identificada: %s (confianca %u%%%s)\n", tabelas_cores_nome(identificacao_atual.candidatas[0].indice),
+               identificacao_atual.confianca, identificacao_atual.ambigua ? ", ambigua" : "");
+    }
+    if (++logs == LOGS_POR_RELATORIO)
+    {
+        logs = 0;
+        escalonador_relatar();
     }
+}
+
+int main()
+{
+    iniciar_sistema(); // Inicializa todos os componentes
+    printf("Paleta: %d cores (hash %08lX)\n", TABELAS_CORES_NUM_CORES, (unsigned long)TABELAS_CORES_HASH);
+#ifdef COLORVIZ_BANCADA
+    bancada_executar(); // Medições de desempenho (só em builds com -DCOLORVIZ_BANCADA=ON)
+#endif
+    multicore_launch_core1(core1_entry);
+    printf("Core 1 lançado com a função core1_entry().\n");
+
+    // Cada etapa no seu ritmo: a taxa de quadros não depende mais do que rodou antes.
+    tarefa_aquisicao = escalonador_adicionar("aquisicao", tarefa_aquisicao_executar, periodo_aquisicao_us());
+    escalonador_adicionar("processamento", tarefa_processamento_executar, PERIODO_PROCESSAMENTO_US);
+    escalonador_adicionar("entrada", tarefa_entrada_executar, PERIODO_ENTRADA_US);
+    escalonador_adicionar("tela", tarefa_tela_executar, PERIODO_TELA_US);
+    escalonador_adicionar("log", tarefa_log_executar, PERIODO_LOG_US);
+
+    escalonador_executar(); // Não retorna
     return 0;
-}
\ No newline at end of file
+}
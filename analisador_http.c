@@ -0,0 +1,279 @@
+// analisador_http.c
+#include "analisador_http.h"
+
+#include <string.h>
+#include <strings.h>
+
+// Fases: uma por parte do pedido. O '\r' é ignorado em todas; aceita-se "\n" sozinho.
+enum {
+    FASE_METODO,
+    FASE_CAMINHO,
+    FASE_VERSAO,
+    FASE_NOME,
+    FASE_VALOR,
+    FASE_CORPO,
+    FASE_FIM,
+};
+
+// Cabeçalhos que interessam ao servidor
+enum {
+    CAMPO_OUTRO,
+    CAMPO_ACCEPT_ENCODING,
+    CAMPO_CONNECTION,
+    CAMPO_CONTENT_LENGTH,
+    CAMPO_TRANSFER_ENCODING,
+    CAMPO_IF_NONE_MATCH,
+    CAMPO_UPGRADE,
+    CAMPO_WEBSOCKET_CHAVE,
+    CAMPO_WEBSOCKET_VERSAO,
+};
+
+static const struct {
+    const char *nome;
+    uint8_t campo;
+} campos[] = {
+    {"Accept-Encoding", CAMPO_ACCEPT_ENCODING},
+    {"Connection", CAMPO_CONNECTION},
+    {"Content-Length", CAMPO_CONTENT_LENGTH},
+    {"Transfer-Encoding", CAMPO_TRANSFER_ENCODING},
+    {"If-None-Match", CAMPO_IF_NONE_MATCH},
+    {"Upgrade", CAMPO_UPGRADE},
+    {"Sec-WebSocket-Key", CAMPO_WEBSOCKET_CHAVE},
+    {"Sec-WebSocket-Version", CAMPO_WEBSOCKET_VERSAO},
+};
+
+void analisador_http_iniciar(analisador_http_t *a) {
+    memset(a, 0, sizeof(*a));
+    a->fase = FASE_METODO;
+}
+
+static analisador_http_resultado_t falhar(analisador_http_t *a, uint16_t status) {
+    a->status = status;
+    a->fase = FASE_FIM;
+    return ANALISADOR_HTTP_ERRO;
+}
+
+// Procura o elemento 'item' numa lista separada por vírgulas, sem diferenciar maiúsculas
+// (parâmetros como ";q=0.8" são ignorados).
+static bool lista_contem(const char *lista, const char *item) {
+    int n = strlen(item);
+    for (const char *p = lista; *p; p++) {
+        if ((p == lista || p[-1] == ',' || p[-1] == ' ') && strncasecmp(p, item, n) == 0 &&
+            (p[n] == '\0' || p[n] == ',' || p[n] == ' ' || p[n] == ';')) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool ler_decimal(const char *texto, uint32_t *valor) {
+    if (*texto < '0' || *texto > '9') {
+        return false;
+    }
+    uint32_t v = 0;
+    for (; *texto >= '0' && *texto <= '9'; texto++) {
+        if (v > (UINT32_MAX - 9) / 10) {
+            return false;
+        }
+        v = v * 10 + (*texto - '0');
+    }
+    *valor = v;
+    return *texto == '\0';
+}
+
+// Guarda o valor em leitura (token), cortado em ANALISADOR_HTTP_VALOR - 1 caracteres.
+static void copiar_valor(char *destino, const analisador_http_t *a) {
+    size_t n = a->token_len < ANALISADOR_HTTP_VALOR - 1 ? a->token_len : ANALISADOR_HTTP_VALOR - 1;
+    memcpy(destino, a->token, n);
+    destino[n] = '\0';
+}
+
+// Fim de um cabeçalho: 'token' tem o valor, sem os espaços das pontas.
+static bool aplicar_campo(analisador_http_t *a) {
+    while (a->token_len > 0 && (a->token[a->token_len - 1] == ' ' || a->token[a->token_len - 1] == '\t')) {
+        a->token_len--;
+    }
+    a->token[a->token_len] = '\0';
+    switch (a->campo) {
+        case CAMPO_ACCEPT_ENCODING:
+            a->aceita_gzip = lista_contem(a->token, "gzip");
+            break;
+        case CAMPO_CONNECTION:
+            if (lista_contem(a->token, "close")) {
+                a->manter_conexao = false;
+            } else if (lista_contem(a->token, "keep-alive")) {
+                a->manter_conexao = true;
+            }
+            break;
+        case CAMPO_CONTENT_LENGTH:
+            if (!ler_decimal(a->token, &a->corpo_restante)) {
+                return false;
+            }
+            break;
+        case CAMPO_TRANSFER_ENCODING:
+            a->status = 501; // Corpo em chunks: não suportado
+            break;
+        case CAMPO_IF_NONE_MATCH:
+            copiar_valor(a->if_none_match, a);
+            break;
+        case CAMPO_UPGRADE:
+            a->upgrade_websocket = lista_contem(a->token, "websocket");
+            break;
+        case CAMPO_WEBSOCKET_CHAVE:
+            copiar_valor(a->websocket_chave, a);
+            break;
+        case CAMPO_WEBSOCKET_VERSAO: {
+            // Fora de 1..0xFFFE (inclusive listas como "8, 13") vira versão desconhecida
+            uint32_t versao;
+            a->websocket_versao = ler_decimal(a->token, &versao) && versao > 0 && versao < UINT16_MAX
+                                      ? (uint16_t)versao
+                                      : UINT16_MAX;
+            break;
+        }
+    }
+    return true;
+}
+
+static void identificar_campo(analisador_http_t *a) {
+    a->token[a->token_len] = '\0';
+    a->campo = CAMPO_OUTRO;
+    for (unsigned i = 0; i < sizeof(campos) / sizeof(campos[0]); i++) {
+        if (strcasecmp(a->token, campos[i].nome) == 0) {
+            a->campo = campos[i].campo;
+            break;
+        }
+    }
+}
+
+// Fim da linha de pedido: método e versão.
+static bool fechar_linha_pedido(analisador_http_t *a) {
+    a->token[a->token_len] = '\0';
+    if (strcmp(a->token, "HTTP/1.1") == 0) {
+        a->http11 = true;
+    } else if (strcmp(a->token, "HTTP/1.0") != 0) {
+        return false;
+    }
+    a->manter_conexao = a->http11;
+    return true;
+}
+
+analisador_http_resultado_t analisador_http_alimentar(analisador_http_t *a, const char *dados, int len,
+                                                      int *consumidos) {
+    int i = 0;
+    analisador_http_resultado_t resultado = ANALISADOR_HTTP_INCOMPLETO;
+
+    while (i < len && resultado == ANALISADOR_HTTP_INCOMPLETO) {
+        if (a->fase == FASE_CORPO) {
+            // O corpo não é usado por nenhuma rota: só é pulado
+            uint32_t n = (uint32_t)(len - i) < a->corpo_restante ? (uint32_t)(len - i) : a->corpo_restante;
+            i += n;
+            a->corpo_restante -= n;
+            if (a->corpo_restante == 0) {
+                a->fase = FASE_FIM;
+                resultado = ANALISADOR_HTTP_COMPLETO;
+            }
+            continue;
+        }
+        if (a->fase == FASE_FIM) {
+            break;
+        }
+
+        char ch = dados[i++];
+        if (a->fase >= FASE_NOME && ++a->cabecalhos_len > ANALISADOR_HTTP_CABECALHOS) {
+            resultado = falhar(a, 431);
+            break;
+        }
+        if (ch == '\r') {
+            continue;
+        }
+
+        switch (a->fase) {
+            case FASE_METODO:
+                if (ch == ' ') {
+                    a->token[a->token_len] = '\0';
+                    a->metodo = strcmp(a->token, "GET") == 0    ? HTTP_METODO_GET
+                                : strcmp(a->token, "HEAD") == 0 ? HTTP_METODO_HEAD
+                                                                : HTTP_METODO_OUTRO;
+                    a->token_len = 0;
+                    a->fase = FASE_CAMINHO;
+                } else if (ch < 'A' || ch > 'Z' || a->token_len >= 7) {
+                    resultado = falhar(a, 400);
+                } else {
+                    a->token[a->token_len++] = ch;
+                }
+                break;
+
+            case FASE_CAMINHO:
+                if (ch == ' ') {
+                    if (a->caminho_len == 0 || a->caminho[0] != '/') {
+                        resultado = falhar(a, 400);
+                        break;
+                    }
+                    a->fase = FASE_VERSAO;
+                } else if (ch == '\n') {
+                    resultado = falhar(a, 400); // HTTP/0.9
+                } else if (a->caminho_len >= sizeof(a->caminho) - 1) {
+                    resultado = falhar(a, 414);
+                } else {
+                    a->caminho[a->caminho_len++] = ch;
+                    a->caminho[a->caminho_len] = '\0';
+                }
+                break;
+
+            case FASE_VERSAO:
+                if (ch == '\n') {
+                    if (!fechar_linha_pedido(a)) {
+                        resultado = falhar(a, 400);
+                        break;
+                    }
+                    a->token_len = 0;
+                    a->fase = FASE_NOME;
+                } else if (a->token_len >= 8) {
+                    resultado = falhar(a, 400);
+                } else {
+                    a->token[a->token_len++] = ch;
+                }
+                break;
+
+            case FASE_NOME:
+                if (ch == '\n') {
+                    if (a->token_len > 0) {
+                        resultado = falhar(a, 400); // Nome sem ':'
+                    } else if (a->status) {
+                        resultado = falhar(a, a->status);
+                    } else if (a->corpo_restante > 0) {
+                        a->fase = FASE_CORPO;
+                    } else {
+                        a->fase = FASE_FIM;
+                        resultado = ANALISADOR_HTTP_COMPLETO;
+                    }
+                } else if (ch == ':') {
+                    identificar_campo(a);
+                    a->token_len = 0;
+                    a->fase = FASE_VALOR;
+                } else if (a->token_len < sizeof(a->token) - 1) {
+                    a->token[a->token_len++] = ch;
+                }
+                // Nomes longos demais não são de interesse: o excesso é ignorado
+                break;
+
+            case FASE_VALOR:
+                if (ch == '\n') {
+                    if (!aplicar_campo(a)) {
+                        resultado = falhar(a, 400);
+                        break;
+                    }
+                    a->token_len = 0;
+                    a->fase = FASE_NOME;
+                } else if ((ch == ' ' || ch == '\t') && a->token_len == 0) {
+                    // Espaços antes do valor
+                } else if (a->token_len < sizeof(a->token) - 1) {
+                    a->token[a->token_len++] = ch;
+                }
+                break;
+        }
+    }
+
+    *consumidos = i;
+    return resultado;
+}
@@ -0,0 +1,67 @@
+// analisador_http.h
+#ifndef ANALISADOR_HTTP_H
+#define ANALISADOR_HTTP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Analisador incremental de pedidos HTTP/1.x, sem alocação: recebe os bytes na
+// ordem em que chegam, em quantos pedaços vierem (um pbuf, parte de um, vários),
+// e guarda só o que o servidor usa: método, caminho, versão e alguns cabeçalhos.
+// Os demais cabeçalhos são lidos e descartados. Não depende do lwIP.
+
+#define ANALISADOR_HTTP_CAMINHO 128    // Caminho com a consulta ("?valor=50")
+#define ANALISADOR_HTTP_VALOR 48       // Valores de cabeçalho guardados
+#define ANALISADOR_HTTP_CABECALHOS 2048 // Tamanho máximo da seção de cabeçalhos
+
+typedef enum {
+    HTTP_METODO_GET,
+    HTTP_METODO_HEAD,
+    HTTP_METODO_OUTRO,
+} http_metodo_t;
+
+typedef enum {
+    ANALISADOR_HTTP_INCOMPLETO, // Todos os bytes foram consumidos; faltam mais
+    ANALISADOR_HTTP_COMPLETO,   // Pedido inteiro (corpo descartado, se houver)
+    ANALISADOR_HTTP_ERRO,       // Pedido inválido; 'status' diz qual resposta dar
+} analisador_http_resultado_t;
+
+typedef struct {
+    // Resultado
+    http_metodo_t metodo;
+    char caminho[ANALISADOR_HTTP_CAMINHO];
+    bool http11;          // HTTP/1.1 (senão, 1.0)
+    bool manter_conexao;  // Keep-alive: padrão do 1.1, pedido explícito no 1.0
+    char if_none_match[ANALISADOR_HTTP_VALOR];
+    char websocket_chave[ANALISADOR_HTTP_VALOR]; // Sec-WebSocket-Key
+    uint16_t websocket_versao; // Sec-WebSocket-Version: 0 = ausente, UINT16_MAX = inválida
+    bool upgrade_websocket; // "websocket" em Upgrade
+    bool aceita_gzip;     // "gzip" em Accept-Encoding
+    uint16_t status;      // Em ANALISADOR_HTTP_ERRO: 400, 414, 431 ou 501
+
+    // Estado interno
+    uint8_t fase;
+    uint8_t campo;        // Cabeçalho cujo valor está sendo lido
+    char token[ANALISADOR_HTTP_VALOR]; // Método, versão, nome ou valor em leitura
+    uint8_t token_len;
+    uint8_t caminho_len;
+    uint16_t cabecalhos_len;
+    uint32_t corpo_restante;
+} analisador_http_t;
+
+/**
+ * @brief Prepara o analisador para um pedido novo (também entre pedidos de uma conexão keep-alive).
+ */
+void analisador_http_iniciar(analisador_http_t *a);
+
+/**
+ * @brief Consome bytes do pedido até o fim dele ou dos dados.
+ *
+ * Para logo depois do último byte do pedido: o que vier depois já é o próximo
+ * (pipelining) e deve ser entregue de novo após analisador_http_iniciar().
+ * @param consumidos Bytes de 'dados' usados.
+ */
+analisador_http_resultado_t analisador_http_alimentar(analisador_http_t *a, const char *dados, int len,
+                                                      int *consumidos);
+
+#endif // ANALISADOR_HTTP_H
@@ -0,0 +1,115 @@
+// arvore_cores.c
+#include "arvore_cores.h"
+#include <stdbool.h>
+
+// Estado de uma busca: os k melhores até agora, ordenados por distância.
+typedef struct {
+    const arvore_cores_t *arvore;
+    uint8_t alvo[3];
+    vizinho_cor_t *vizinhos;
+    int k;
+    int encontrados;
+} busca_t;
+
+// Ordem dos resultados: menor distância primeiro; empate fica com o menor índice.
+static bool melhor_que(uint32_t distancia2, uint16_t indice, const vizinho_cor_t *v)
+{
+    return distancia2 < v->distancia2 || (distancia2 == v->distancia2 && indice < v->indice);
+}
+
+// Distância que um ramo precisa igualar para ainda poder entrar no resultado.
+static uint32_t pior_aceito(const busca_t *busca)
+{
+    return (busca->encontrados < busca->k) ? UINT32_MAX : busca->vizinhos[busca->k - 1].distancia2;
+}
+
+static void inserir(busca_t *busca, uint32_t distancia2, uint16_t indice)
+{
+    int pos = busca->encontrados;
+    if (pos == busca->k)
+    {
+        if (!melhor_que(distancia2, indice, &busca->vizinhos[pos - 1]))
+        {
+            return;
+        }
+        pos--;
+    }
+    else
+    {
+        busca->encontrados++;
+    }
+    // Inserção ordenada: k é pequeno.
+    while (pos > 0 && melhor_que(distancia2, indice, &busca->vizinhos[pos - 1]))
+    {
+        busca->vizinhos[pos] = busca->vizinhos[pos - 1];
+        pos--;
+    }
+    busca->vizinhos[pos].indice = indice;
+    busca->vizinhos[pos].distancia2 = distancia2;
+}
+
+static void buscar(busca_t *busca, uint16_t ini, uint16_t fim)
+{
+    while (ini < fim)
+    {
+        const arvore_cores_t *arvore = busca->arvore;
+        uint16_t meio = (uint16_t)((ini + fim) / 2);
+        const uint8_t *p = arvore->ponto[meio];
+
+        int32_t dr = (int32_t)busca->alvo[0] - p[0];
+        int32_t dg = (int32_t)busca->alvo[1] - p[1];
+        int32_t db = (int32_t)busca->alvo[2] - p[2];
+        inserir(busca, (uint32_t)(dr * dr + dg * dg + db * db), arvore->indice[meio]);
+
+        uint8_t eixo = arvore->eixo[meio];
+        int32_t diferenca = (int32_t)busca->alvo[eixo] - p[eixo];
+
+        // Desce primeiro pelo lado do alvo; o outro lado só é visitado se o plano
+        // de corte estiver mais perto que o pior resultado aceito (<= por causa dos empates).
+        uint16_t perto_ini, perto_fim, longe_ini, longe_fim;
+        if (diferenca < 0)
+        {
+            perto_ini = ini;      perto_fim = meio;
+            longe_ini = meio + 1; longe_fim = fim;
+        }
+        else
+        {
+            perto_ini = meio + 1; perto_fim = fim;
+            longe_ini = ini;      longe_fim = meio;
+        }
+
+        buscar(busca, perto_ini, perto_fim);
+        if ((uint32_t)(diferenca * diferenca) > pior_aceito(busca))
+        {
+            return;
+        }
+        // O lado distante continua no laço em vez de outra chamada recursiva.
+        ini = longe_ini;
+        fim = longe_fim;
+    }
+}
+
+int arvore_cores_k_mais_proximas(const arvore_cores_t *arvore, uint8_t r, uint8_t g, uint8_t b,
+                                 vizinho_cor_t *vizinhos, int k)
+{
+    if (k <= 0)
+    {
+        return 0;
+    }
+    busca_t busca = {
+        .arvore = arvore,
+        .alvo = {r, g, b},
+        .vizinhos = vizinhos,
+        .k = k,
+        .encontrados = 0,
+    };
+    buscar(&busca, 0, arvore->num_nos);
+    return busca.encontrados;
+}
+
+uint16_t arvore_cores_mais_proxima(const arvore_cores_t *arvore, uint8_t r, uint8_t g, uint8_t b)
+{
+    vizinho_cor_t vizinho = {0, UINT32_MAX};
+    arvore_cores_k_mais_proximas(arvore, r, g, b, &vizinho, 1);
+    return vizinho.indice;
+}
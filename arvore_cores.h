@@ -0,0 +1,40 @@
+// arvore_cores.h
+// Árvore k-d estática sobre as cores da base, montada no build por
+// tools/gerar_tabelas_cores.py. Fica em flash num vetor implícito, sem ponteiros:
+// o nó de um intervalo [ini, fim) é o elemento do meio; à esquerda ficam
+// [ini, meio) e à direita [meio + 1, fim).
+#ifndef ARVORE_CORES_H
+#define ARVORE_CORES_H
+
+#include <stdint.h>
+
+typedef struct {
+    const uint8_t (*ponto)[3]; // RGB de cada nó
+    const uint16_t *indice;    // Posição da cor do nó na paleta
+    const uint8_t *eixo;       // Eixo de corte do nó (0 = R, 1 = G, 2 = B)
+    uint16_t num_nos;
+} arvore_cores_t;
+
+// Resultado de uma busca: índice na base e distância euclidiana ao quadrado.
+typedef struct {
+    uint16_t indice;
+    uint32_t distancia2;
+} vizinho_cor_t;
+
+/**
+ * @brief Cor da base mais próxima de (r, g, b), em distância euclidiana no RGB.
+ *
+ * Empates ficam com o menor índice da base, como na varredura linear.
+ * @return Índice da cor na paleta (tabelas_cores.h).
+ */
+uint16_t arvore_cores_mais_proxima(const arvore_cores_t *arvore, uint8_t r, uint8_t g, uint8_t b);
+
+/**
+ * @brief As k cores mais próximas de (r, g, b), da mais próxima para a mais distante.
+ * @param vizinhos Vetor de saída com espaço para k elementos.
+ * @return Quantidade preenchida (menor que k se a base tiver menos cores).
+ */
+int arvore_cores_k_mais_proximas(const arvore_cores_t *arvore, uint8_t r, uint8_t g, uint8_t b,
+                                 vizinho_cor_t *vizinhos, int k);
+
+#endif // ARVORE_CORES_H
@@ -0,0 +1,312 @@
+// bancada.c
+// Cada medição roda o trecho N vezes e conta ciclos de clock com o SysTick
+// (o Cortex-M0+ não tem o contador de ciclos DWT). O custo da chamada vazia é
+// descontado, então o resultado é o custo do trecho em si.
+#include "bancada.h"
+
+#include <stdio.h>
+#include <math.h>
+
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/structs/systick.h"
+
+#include "controle_exposicao.h"
+#include "cor_lab.h"
+#include "filtros_daltonismo.h"
+#include "identificador_cor.h"
+#include "tabelas_cores.h"
+#include "transferencia_srgb.h"
+
+#define BANCADA_REPETICOES 1000
+// Identificação: até o orçamento (~31 k ciclos a 125 MHz) e bases grandes no motor
+// linear; com menos repetições, o total cabe nos 24 bits do SysTick até ~2.7 ms por amostra.
+#define BANCADA_REPETICOES_IDENTIFICACAO 50
+
+// Pixels por lote nas medições dos filtros em lote: o SysTick tem 24 bits, então
+// BANCADA_REPETICOES lotes precisam caber em ~16 M ciclos.
+#define BANCADA_LOTE_PIXELS 64
+
+// Orçamento da identificação por amostra. A conversão mais curta do sensor
+// leva 2.4 ms; a identificação não deve passar de ~10% disso. Ainda não medido
+// no RP2040 com o ΔE2000: por isso o motor lab usa só ΔE76 por padrão
+// (opção COLORVIZ_LAB_DELTA_E2000 do CMake).
+#define BANCADA_ORCAMENTO_IDENTIFICACAO_US 250
+
+// Impede que o compilador elimine os resultados não usados.
+static volatile uint8_t sumidouro;
+
+typedef void (*trecho_t)(uint32_t i);
+
+// Retorno de medir_ciclos() quando o total passou de 2^24 ciclos: o SysTick deu a
+// volta e a diferença de contagens não vale nada.
+#define BANCADA_ESTOURO UINT32_MAX
+
+static uint32_t medir_ciclos(trecho_t trecho, uint32_t repeticoes)
+{
+    systick_hw->rvr = 0x00FFFFFF;
+    systick_hw->cvr = 0;
+    systick_hw->csr = 0x5; // Habilitado, clock do processador, sem interrupção
+
+    uint32_t inicio;
+    do
+    {
+        inicio = systick_hw->cvr; // Espera a primeira recarga a partir do RVR
+    } while (inicio == 0);
+    (void)systick_hw->csr; // A leitura zera o COUNTFLAG
+    for (uint32_t i = 0; i < repeticoes; i++)
+    {
+        trecho(i);
+    }
+    uint32_t fim = systick_hw->cvr;
+    // COUNTFLAG: o contador chegou a zero desde a última leitura, isto é, deu a volta
+    if (systick_hw->csr & M0PLUS_SYST_CSR_COUNTFLAG_BITS)
+    {
+        return BANCADA_ESTOURO;
+    }
+    // O SysTick conta para baixo (24 bits)
+    return (inicio - fim) / repeticoes;
+}
+
+static void trecho_vazio(uint32_t i)
+{
+    sumidouro = (uint8_t)i;
+}
+
+static uint32_t relatar_repeticoes(const char *nome, trecho_t trecho, uint32_t base, uint32_t repeticoes)
+{
+    uint32_t ciclos = medir_ciclos(trecho, repeticoes);
+    if (ciclos == BANCADA_ESTOURO)
+    {
+        printf("  %-32s estouro do SysTick (mais de 2^24 ciclos no total)\n", nome);
+        return BANCADA_ESTOURO;
+    }
+    ciclos = (ciclos > base) ? ciclos - base : 0;
+    printf("  %-32s %6lu ciclos/amostra\n", nome, (unsigned long)ciclos);
+    return ciclos;
+}
+
+static uint32_t relatar(const char *nome, trecho_t trecho, uint32_t base)
+{
+    return relatar_repeticoes(nome, trecho, base, BANCADA_REPETICOES);
+}
+
+// --- Normalização: referência em float x Q16 ---
+
+static void normalizar_float(uint16_t r, uint16_t g, uint16_t b, uint16_t clear,
+                             uint8_t *r_out, uint8_t *g_out, uint8_t *b_out)
+{
+    *r_out = (uint8_t)fminf(255.0f, ((float)r / clear) * 255.0f);
+    *g_out = (uint8_t)fminf(255.0f, ((float)g / clear) * 255.0f);
+    *b_out = (uint8_t)fminf(255.0f, ((float)b / clear) * 255.0f);
+}
+
+// Amostra de teste: canais que variam com i e o clear um pouco acima da soma deles.
+#define BANCADA_CLEAR(i) ((uint16_t)((i) * 33 + 1))
+
+static void trecho_normalizar_float(uint32_t i)
+{
+    uint8_t r, g, b;
+    normalizar_float(i * 7, i * 11, i * 13, BANCADA_CLEAR(i), &r, &g, &b);
+    sumidouro = r ^ g ^ b;
+}
+
+static void trecho_normalizar_q16(uint32_t i)
+{
+    uint8_t r, g, b;
+    controle_exposicao_normalizar_rgb(i * 7, i * 11, i * 13, BANCADA_CLEAR(i), &r, &g, &b);
+    sumidouro = r ^ g ^ b;
+}
+
+// --- Identificação: varredura linear da base x motor configurado (LUT, árvore k-d ou Lab) ---
+
+static void trecho_identificar_linear(uint32_t i)
+{
+    uint8_t r = i * 7, g = i * 11, b = i * 13;
+    uint32_t menor_distancia = UINT32_MAX;
+    int indice = 0;
+    for (int c = 0; c < TABELAS_CORES_NUM_CORES; c++)
+    {
+        int32_t dr = (int32_t)r - cores_rgb_sensor[c][0];
+        int32_t dg = (int32_t)g - cores_rgb_sensor[c][1];
+        int32_t db = (int32_t)b - cores_rgb_sensor[c][2];
+        uint32_t distancia = (uint32_t)(dr * dr + dg * dg + db * db);
+        if (distancia < menor_distancia)
+        {
+            menor_distancia = distancia;
+            indice = c;
+        }
+    }
+    sumidouro = cores_rgb_ideal[indice][0];
+}
+
+// O caminho usado em execução: as k candidatas, no pior caso de k.
+static void trecho_identificar_motor(uint32_t i)
+{
+    identificacao_cor_t resultado;
+    identificar_cor_candidatas(i * 7, i * 11, i * 13, IDENTIFICACAO_MAX_CANDIDATAS, &resultado);
+    sumidouro = (uint8_t)resultado.candidatas[0].indice;
+}
+
+// --- CIELAB: conversão em ponto fixo e ΔE2000 de um par ---
+
+static void trecho_lab_conversao(uint32_t i)
+{
+    cor_lab_t lab;
+    cor_lab_de_rgb(i * 7, i * 11, i * 13, &lab);
+    sumidouro = (uint8_t)lab.l;
+}
+
+static void trecho_lab_delta_e2000(uint32_t i)
+{
+    cor_lab_t x = {(int16_t)(i & 0x1FFF), (int16_t)(i * 3 - 1500), (int16_t)(700 - i * 5)};
+    cor_lab_t y = {3200, 640, -960};
+    sumidouro = (uint8_t)cor_lab_delta_e2000(&x, &y);
+}
+
+// --- Funções de transferência sRGB: powf x tabela ---
+
+static void trecho_transferencia_powf(uint32_t i)
+{
+    uint8_t canais[3] = {(uint8_t)(i * 7), (uint8_t)(i * 11), (uint8_t)(i * 13)};
+    for (int c = 0; c < 3; c++)
+    {
+        float v = canais[c] / 255.0f;
+        v = (v <= 0.04045f) ? (v / 12.92f) : powf((v + 0.055f) / 1.055f, 2.4f);
+        v = (v <= 0.0031308f) ? (v * 12.92f) : (1.055f * powf(v, 1.0f / 2.4f) - 0.055f);
+        canais[c] = (uint8_t)(v * 255.0f + 0.5f);
+    }
+    sumidouro = canais[0] ^ canais[1] ^ canais[2];
+}
+
+static void trecho_transferencia_tabela(uint32_t i)
+{
+    uint8_t canais[3] = {(uint8_t)(i * 7), (uint8_t)(i * 11), (uint8_t)(i * 13)};
+    for (int c = 0; c < 3; c++)
+    {
+        canais[c] = linear_q12_para_srgb(srgb_para_linear_q12(canais[c]));
+    }
+    sumidouro = canais[0] ^ canais[1] ^ canais[2];
+}
+
+static void trecho_filtro_protanopia(uint32_t i)
+{
+    uint8_t r = i * 7, g = i * 11, b = i * 13;
+    aplicar_filtro_daltonismo(DALTONISMO_PROTANOPIA, DALTONISMO_SEVERIDADE_MAX, &r, &g, &b);
+    sumidouro = r ^ g ^ b;
+}
+
+static void trecho_filtros_separados(uint32_t i)
+{
+    uint8_t x = 0;
+    for (int t = 0; t < DALTONISMO_NUM_TIPOS; t++)
+    {
+        uint8_t r = i * 7, g = i * 11, b = i * 13;
+        aplicar_filtro_daltonismo((tipo_daltonismo_t)t, DALTONISMO_SEVERIDADE_MAX, &r, &g, &b);
+        x ^= r ^ g ^ b;
+    }
+    sumidouro = x;
+}
+
+static void trecho_todos_modos(uint32_t i)
+{
+    uint8_t saida[DALTONISMO_NUM_TIPOS + 1][3];
+    simular_todos_daltonismos(DALTONISMO_SEVERIDADE_MAX, i * 7, i * 11, i * 13, saida, NULL);
+    sumidouro = saida[1][0] ^ saida[2][1] ^ saida[DALTONISMO_NUM_TIPOS][2];
+}
+
+static void trecho_todos_modos_daltonizados(uint32_t i)
+{
+    uint8_t saida[DALTONISMO_NUM_TIPOS + 1][3];
+    uint8_t daltonizado[DALTONISMO_NUM_TIPOS + 1][3];
+    simular_todos_daltonismos(DALTONISMO_SEVERIDADE_MAX, i * 7, i * 11, i * 13, saida, daltonizado);
+    sumidouro = saida[1][0] ^ daltonizado[2][1] ^ daltonizado[DALTONISMO_NUM_TIPOS][2];
+}
+
+static void trecho_daltonizacao_protanopia(uint32_t i)
+{
+    uint8_t r = i * 7, g = i * 11, b = i * 13;
+    aplicar_daltonizacao(DALTONISMO_PROTANOPIA, DALTONISMO_SEVERIDADE_MAX, &r, &g, &b);
+    sumidouro = r ^ g ^ b;
+}
+
+static uint8_t lote_rgb888[BANCADA_LOTE_PIXELS * 3];
+static uint16_t lote_rgb565[BANCADA_LOTE_PIXELS];
+
+static void trecho_lote_rgb888(uint32_t i)
+{
+    (void)i;
+    filtrar_daltonismo_rgb888_no_lugar(DALTONISMO_PROTANOPIA, DALTONISMO_SEVERIDADE_MAX, lote_rgb888, BANCADA_LOTE_PIXELS);
+    sumidouro = lote_rgb888[0];
+}
+
+static void trecho_lote_rgb565(uint32_t i)
+{
+    (void)i;
+    filtrar_daltonismo_rgb565_no_lugar(DALTONISMO_PROTANOPIA, DALTONISMO_SEVERIDADE_MAX, lote_rgb565, BANCADA_LOTE_PIXELS);
+    sumidouro = (uint8_t)lote_rgb565[0];
+}
+
+// Ciclos por lote -> megapixels por segundo, com duas casas
+static void relatar_lote(const char *nome, trecho_t trecho, uint32_t base, uint32_t mhz)
+{
+    uint32_t ciclos = relatar(nome, trecho, base);
+    if (ciclos == BANCADA_ESTOURO)
+    {
+        return;
+    }
+    uint32_t centesimos = ciclos ? (uint32_t)((uint64_t)mhz * BANCADA_LOTE_PIXELS * 100 / ciclos) : 0;
+    printf("  %-32s %3lu.%02lu Mpix/s (%lu ciclos/pixel)\n", "", (unsigned long)(centesimos / 100),
+           (unsigned long)(centesimos % 100), (unsigned long)(ciclos / BANCADA_LOTE_PIXELS));
+}
+
+void bancada_executar(void)
+{
+    uint32_t base = medir_ciclos(trecho_vazio, BANCADA_REPETICOES);
+    printf("--- Bancada (%d repeticoes, custo da chamada: %lu ciclos) ---\n",
+           BANCADA_REPETICOES, (unsigned long)base);
+
+    printf("Normalizacao:\n");
+    relatar("float (referencia)", trecho_normalizar_float, base);
+    relatar("Q16", trecho_normalizar_q16, base);
+
+    printf("Identificacao (%d cores, %d repeticoes):\n", TABELAS_CORES_NUM_CORES, BANCADA_REPETICOES_IDENTIFICACAO);
+    relatar_repeticoes("varredura linear", trecho_identificar_linear, base, BANCADA_REPETICOES_IDENTIFICACAO);
+    uint32_t ciclos_motor = relatar_repeticoes("motor configurado (k candidatas)", trecho_identificar_motor, base,
+                                               BANCADA_REPETICOES_IDENTIFICACAO);
+    relatar("rgb -> Lab (ponto fixo)", trecho_lab_conversao, base);
+    relatar("dE2000 (um par)", trecho_lab_delta_e2000, base);
+
+    printf("Transferencia sRGB (ida e volta, 3 canais):\n");
+    relatar("powf (referencia)", trecho_transferencia_powf, base);
+    relatar("tabelas Q12", trecho_transferencia_tabela, base);
+    relatar(TABELAS_FILTROS_LUT ? "filtro protanopia (LUT 3D)" : "filtro protanopia (matriz)",
+            trecho_filtro_protanopia, base);
+    relatar("todos os tipos, chamadas separadas", trecho_filtros_separados, base);
+    relatar("todos os modos numa passada", trecho_todos_modos, base);
+    relatar("daltonizacao protanopia", trecho_daltonizacao_protanopia, base);
+    relatar("todos os modos + daltonizacao", trecho_todos_modos_daltonizados, base);
+
+    uint32_t mhz = clock_get_hz(clk_sys) / 1000000;
+    for (int p = 0; p < BANCADA_LOTE_PIXELS; p++)
+    {
+        lote_rgb888[3 * p] = p * 7;
+        lote_rgb888[3 * p + 1] = p * 11;
+        lote_rgb888[3 * p + 2] = p * 13;
+        lote_rgb565[p] = (uint16_t)(p * 1021);
+    }
+    printf("Filtro em lote (%d pixels, protanopia):\n", BANCADA_LOTE_PIXELS);
+    relatar_lote("RGB888", trecho_lote_rgb888, base, mhz);
+    relatar_lote("RGB565", trecho_lote_rgb565, base, mhz);
+
+    if (ciclos_motor == BANCADA_ESTOURO)
+    {
+        uint32_t limite_us = 0x00FFFFFFu / BANCADA_REPETICOES_IDENTIFICACAO / mhz;
+        printf("  identificacao: mais de %lu us/amostra (orcamento %d us) ESTOURO\n", (unsigned long)limite_us,
+               BANCADA_ORCAMENTO_IDENTIFICACAO_US);
+        return;
+    }
+    uint32_t us = ciclos_motor / mhz;
+    printf("  identificacao: %lu us/amostra (orcamento %d us) %s\n", (unsigned long)us,
+           BANCADA_ORCAMENTO_IDENTIFICACAO_US, us <= BANCADA_ORCAMENTO_IDENTIFICACAO_US ? "OK" : "ESTOURO");
+}
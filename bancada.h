@@ -0,0 +1,11 @@
+// bancada.h
+// Medições de desempenho no alvo (habilitadas com -DCOLORVIZ_BANCADA=ON no CMake).
+#ifndef BANCADA_H
+#define BANCADA_H
+
+/**
+ * @brief Executa todas as medições e imprime os ciclos por amostra na serial USB.
+ */
+void bancada_executar(void);
+
+#endif // BANCADA_H
@@ -0,0 +1,395 @@
+// canal_websocket.c
+#include "canal_websocket.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// Maior quadro aceito do cliente: comandos têm 2 bytes; ping e close, até 125.
+#define WEBSOCKET_MAX_CARGA 125
+// Cabeçalho do cliente (2 bytes + máscara de 4) mais a carga
+#define WEBSOCKET_BUFFER_RX (6 + WEBSOCKET_MAX_CARGA)
+
+// Opcodes (RFC 6455, seção 5.2)
+#define OP_TEXTO 0x1
+#define OP_BINARIO 0x2
+#define OP_FECHAR 0x8
+#define OP_PING 0x9
+#define OP_PONG 0xA
+
+// Códigos de fechamento (seção 7.4.1)
+#define FECHAR_NORMAL 1000
+#define FECHAR_PROTOCOLO 1002
+#define FECHAR_GRANDE 1009
+
+typedef struct {
+    struct tcp_pcb *pcb; // NULL = lugar livre
+    uint8_t recebido[WEBSOCKET_BUFFER_RX];
+    uint8_t quantidade;
+    uint8_t intervalo; // Uma amostra a cada 'intervalo' (0 = pausa)
+    uint8_t contador;
+} cliente_ws_t;
+
+static cliente_ws_t clientes[WEBSOCKET_MAX_CLIENTES];
+
+// --- SHA-1 (FIPS 180-4), só para o Sec-WebSocket-Accept do handshake ---
+
+#define ROTL(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+
+static void sha1_bloco(uint32_t h[5], const uint8_t bloco[64]) {
+    uint32_t w[80];
+    for (int i = 0; i < 16; i++) {
+        w[i] = (uint32_t)bloco[4 * i] << 24 | (uint32_t)bloco[4 * i + 1] << 16 |
+               (uint32_t)bloco[4 * i + 2] << 8 | bloco[4 * i + 3];
+    }
+    for (int i = 16; i < 80; i++) {
+        w[i] = ROTL(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+    }
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+    for (int i = 0; i < 80; i++) {
+        uint32_t f, k;
+        if (i < 20) {
+            f = (b & c) | (~b & d);
+            k = 0x5A827999;
+        } else if (i < 40) {
+            f = b ^ c ^ d;
+            k = 0x6ED9EBA1;
+        } else if (i < 60) {
+            f = (b & c) | (b & d) | (c & d);
+            k = 0x8F1BBCDC;
+        } else {
+            f = b ^ c ^ d;
+            k = 0xCA62C1D6;
+        }
+        uint32_t t = ROTL(a, 5) + f + e + k + w[i];
+        e = d;
+        d = c;
+        c = ROTL(b, 30);
+        b = a;
+        a = t;
+    }
+    h[0] += a;
+    h[1] += b;
+    h[2] += c;
+    h[3] += d;
+    h[4] += e;
+}
+
+static void sha1(const uint8_t *dados, size_t len, uint8_t resumo[20]) {
+    uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+    uint8_t bloco[64];
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64) {
+        sha1_bloco(h, dados + i);
+    }
+    // Último bloco: o resto, o bit 1, zeros e o tamanho em bits (big-endian)
+    size_t resto = len - i;
+    memset(bloco, 0, sizeof(bloco));
+    memcpy(bloco, dados + i, resto);
+    bloco[resto] = 0x80;
+    if (resto >= 56) {
+        sha1_bloco(h, bloco);
+        memset(bloco, 0, sizeof(bloco));
+    }
+    uint64_t bits = (uint64_t)len * 8;
+    for (int j = 0; j < 8; j++) {
+        bloco[63 - j] = (uint8_t)(bits >> (8 * j));
+    }
+    sha1_bloco(h, bloco);
+    for (int j = 0; j < 20; j++) {
+        resumo[j] = (uint8_t)(h[j / 4] >> (24 - 8 * (j % 4)));
+    }
+}
+
+static void base64(const uint8_t *dados, size_t len, char *saida) {
+    static const char alfabeto[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    size_t i = 0;
+    for (; i + 2 < len; i += 3) {
+        uint32_t v = (uint32_t)dados[i] << 16 | (uint32_t)dados[i + 1] << 8 | dados[i + 2];
+        *saida++ = alfabeto[v >> 18];
+        *saida++ = alfabeto[(v >> 12) & 63];
+        *saida++ = alfabeto[(v >> 6) & 63];
+        *saida++ = alfabeto[v & 63];
+    }
+    if (i < len) {
+        uint32_t v = (uint32_t)dados[i] << 16 | (i + 1 < len ? (uint32_t)dados[i + 1] << 8 : 0);
+        *saida++ = alfabeto[v >> 18];
+        *saida++ = alfabeto[(v >> 12) & 63];
+        *saida++ = i + 1 < len ? alfabeto[(v >> 6) & 63] : '=';
+        *saida++ = '=';
+    }
+    *saida = '\0';
+}
+
+// --- Quadros ---
+
+// Quadro do aparelho: sem máscara, sempre com FIN, carga de até 125 bytes.
+static bool enviar_quadro(cliente_ws_t *c, uint8_t opcode, const uint8_t *carga, uint8_t len) {
+    uint8_t quadro[2 + WEBSOCKET_MAX_CARGA];
+    quadro[0] = 0x80 | opcode;
+    quadro[1] = len;
+    memcpy(quadro + 2, carga, len);
+    if (tcp_sndbuf(c->pcb) < 2 + len || tcp_write(c->pcb, quadro, 2 + len, TCP_WRITE_FLAG_COPY) != ERR_OK) {
+        return false;
+    }
+    tcp_output(c->pcb);
+    return true;
+}
+
+// Desfaz os callbacks e fecha; devolve true se o pcb foi abortado.
+static bool fechar_conexao(cliente_ws_t *c) {
+    struct tcp_pcb *pcb = c->pcb;
+    c->pcb = NULL;
+    tcp_arg(pcb, NULL);
+    tcp_recv(pcb, NULL);
+    tcp_err(pcb, NULL);
+    tcp_poll(pcb, NULL, 0);
+    if (tcp_close(pcb) != ERR_OK) {
+        tcp_abort(pcb);
+        return true;
+    }
+    return false;
+}
+
+// Envia o quadro de fechamento com o código e encerra a conexão.
+static bool fechar(cliente_ws_t *c, uint16_t codigo) {
+    uint8_t carga[2] = {(uint8_t)(codigo >> 8), (uint8_t)codigo};
+    enviar_quadro(c, OP_FECHAR, carga, sizeof(carga));
+    return fechar_conexao(c);
+}
+
+static void executar_comando(cliente_ws_t *c, const uint8_t *carga, uint8_t len) {
+    if (len != 2) {
+        return;
+    }
+    uint8_t comando = carga[0], valor = carga[1];
+    bool aceito = true;
+    switch (comando) {
+    case WEBSOCKET_CMD_MODO:
+        aceito = valor <= DALTONISMO_NUM_TIPOS;
+        if (aceito) {
+            pedir_modo_web(valor);
+        }
+        break;
+    case WEBSOCKET_CMD_SEVERIDADE:
+        aceito = valor <= 100;
+        if (aceito) {
+            shared_severidade = (valor * DALTONISMO_SEVERIDADE_MAX + 50) / 100; // Aplicada no próximo quadro
+        }
+        break;
+    case WEBSOCKET_CMD_INTERVALO:
+        c->intervalo = valor;
+        c->contador = 0;
+        break;
+    default:
+        aceito = false;
+        break;
+    }
+    uint8_t resposta[3] = {WEBSOCKET_RESPOSTA, comando, aceito};
+    enviar_quadro(c, OP_BINARIO, resposta, sizeof(resposta));
+}
+
+// O primeiro quadro do buffer encerra a conexão: erro de protocolo (já decidido pelos
+// 2 bytes do cabeçalho) ou pedido de fechamento completo.
+static bool quadro_encerra(const cliente_ws_t *c) {
+    if (c->quantidade < 2) {
+        return false;
+    }
+    const uint8_t *q = c->recebido;
+    uint8_t len = q[1] & 0x7F;
+    if (!(q[1] & 0x80) || !(q[0] & 0x80) || len > WEBSOCKET_MAX_CARGA) {
+        return true;
+    }
+    return (q[0] & 0x0F) == OP_FECHAR && c->quantidade >= 6 + len;
+}
+
+// Processa os quadros completos em c->recebido. Devolve true se o pcb foi abortado.
+// Sem 'pode_fechar', para no primeiro quadro que encerraria a conexão e o deixa no buffer.
+static bool processar_quadros(cliente_ws_t *c, bool pode_fechar, bool *fechado) {
+    while (c->quantidade >= 2) {
+        uint8_t *q = c->recebido;
+        bool fin = q[0] & 0x80;
+        uint8_t opcode = q[0] & 0x0F;
+        uint8_t len = q[1] & 0x7F;
+        if (!pode_fechar && quadro_encerra(c)) {
+            return false;
+        }
+        // Quadros do cliente sempre têm máscara; fragmentos e cargas longas não são usados aqui
+        if (!(q[1] & 0x80) || !fin) {
+            *fechado = true;
+            return fechar(c, FECHAR_PROTOCOLO);
+        }
+        if (len > WEBSOCKET_MAX_CARGA) {
+            *fechado = true;
+            return fechar(c, FECHAR_GRANDE);
+        }
+        if (c->quantidade < 6 + len) {
+            return false; // Falta o resto do quadro
+        }
+        uint8_t *carga = q + 6;
+        for (int i = 0; i < len; i++) {
+            carga[i] ^= q[2 + (i & 3)];
+        }
+
+        switch (opcode) {
+        case OP_BINARIO:
+            executar_comando(c, carga, len);
+            break;
+        case OP_PING:
+            enviar_quadro(c, OP_PONG, carga, len);
+            break;
+        case OP_FECHAR:
+            *fechado = true;
+            return fechar(c, FECHAR_NORMAL);
+        default: // Texto e pong: nada a fazer
+            break;
+        }
+
+        c->quantidade -= 6 + len;
+        memmove(c->recebido, c->recebido + 6 + len, c->quantidade);
+    }
+    return false;
+}
+
+static err_t cliente_recv(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err) {
+    cliente_ws_t *c = (cliente_ws_t *)arg;
+    if (!p) {
+        return fechar_conexao(c) ? ERR_ABRT : ERR_OK;
+    }
+    tcp_recved(pcb, p->tot_len);
+    uint16_t lido = 0;
+    bool abortado = false, fechado = false;
+    while (lido < p->tot_len && !fechado) {
+        uint16_t n = pbuf_copy_partial(p, c->recebido + c->quantidade, sizeof(c->recebido) - c->quantidade, lido);
+        c->quantidade += n;
+        lido += n;
+        abortado = processar_quadros(c, true, &fechado);
+    }
+    pbuf_free(p);
+    return abortado ? ERR_ABRT : ERR_OK;
+}
+
+// Quadro que veio com o pedido do handshake e encerraria a conexão: fechado aqui, fora
+// do callback de recepção do servidor HTTP, onde um abort não poderia ser devolvido ao lwIP.
+static err_t cliente_poll(void *arg, struct tcp_pcb *pcb) {
+    cliente_ws_t *c = (cliente_ws_t *)arg;
+    tcp_poll(pcb, NULL, 0);
+    bool fechado = false;
+    return processar_quadros(c, true, &fechado) ? ERR_ABRT : ERR_OK;
+}
+
+static void cliente_err(void *arg, err_t err) {
+    cliente_ws_t *c = (cliente_ws_t *)arg;
+    if (c) {
+        c->pcb = NULL; // O lwIP já liberou o pcb
+    }
+}
+
+// --- Handshake ---
+
+bool canal_websocket_aceitar(struct tcp_pcb *pcb, const char *chave_cliente, const struct pbuf *resto) {
+    static const char guid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+    char chave[32 + sizeof(guid)];
+    // A chave são 16 bytes em base64: 24 caracteres
+    size_t n_chave = strlen(chave_cliente);
+    if (n_chave == 0 || n_chave >= 32) {
+        return false;
+    }
+    // O cliente não devia mandar nada antes do 101; mais que um quadro inteiro, recusa
+    uint16_t n_resto = resto ? resto->tot_len : 0;
+    if (n_resto > WEBSOCKET_BUFFER_RX) {
+        return false;
+    }
+    cliente_ws_t *c = NULL;
+    for (int i = 0; i < WEBSOCKET_MAX_CLIENTES && !c; i++) {
+        if (!clientes[i].pcb) {
+            c = &clientes[i];
+        }
+    }
+    if (!c) {
+        return false;
+    }
+
+    // Sec-WebSocket-Accept = base64(SHA-1(chave + GUID))
+    memcpy(chave, chave_cliente, n_chave);
+    memcpy(chave + n_chave, guid, sizeof(guid));
+    uint8_t resumo[20];
+    sha1((const uint8_t *)chave, strlen(chave), resumo);
+    char aceite[29];
+    base64(resumo, sizeof(resumo), aceite);
+
+    char resposta[160];
+    int n = snprintf(resposta, sizeof(resposta),
+                     "HTTP/1.1 101 Switching Protocols\r\n"
+                     "Upgrade: websocket\r\n"
+                     "Connection: Upgrade\r\n"
+                     "Sec-WebSocket-Accept: %s\r\n"
+                     "\r\n",
+                     aceite);
+    if (tcp_write(pcb, resposta, n, TCP_WRITE_FLAG_COPY) != ERR_OK) {
+        return false;
+    }
+
+    c->pcb = pcb;
+    c->quantidade = n_resto ? pbuf_copy_partial(resto, c->recebido, n_resto, 0) : 0;
+    c->intervalo = 1;
+    c->contador = 0;
+    tcp_arg(pcb, c);
+    tcp_recv(pcb, cliente_recv);
+    tcp_err(pcb, cliente_err);
+    tcp_sent(pcb, NULL);
+    // Os quadros completos que vieram com o pedido são atendidos já; um quadro
+    // incompleto espera o resto em cliente_recv, e só o que encerraria a conexão
+    // fica para o poll.
+    bool fechado = false;
+    processar_quadros(c, false, &fechado);
+    tcp_poll(pcb, quadro_encerra(c) ? cliente_poll : NULL, 1);
+    tcp_nagle_disable(pcb); // Quadros pequenos: a latência importa mais que o tamanho
+    tcp_output(pcb);
+    return true;
+}
+
+static void escrever_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void escrever_u32(uint8_t *p, uint32_t v) {
+    escrever_u16(p, (uint16_t)v);
+    escrever_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+void canal_websocket_enviar_amostra(const amostra_cor_t *amostra) {
+    uint8_t quadro[14 + 2 * 3 * (DALTONISMO_NUM_TIPOS + 1)];
+    bool codificado = false;
+
+    for (int i = 0; i < WEBSOCKET_MAX_CLIENTES; i++) {
+        cliente_ws_t *c = &clientes[i];
+        if (!c->pcb || c->intervalo == 0 || ++c->contador < c->intervalo) {
+            continue;
+        }
+        c->contador = 0;
+        if (!codificado) {
+            codificado = true;
+            quadro[0] = WEBSOCKET_AMOSTRA;
+            quadro[1] = (uint8_t)amostra->cor.modo;
+            quadro[2] = (uint8_t)(amostra->cor.severidade * 100 / DALTONISMO_SEVERIDADE_MAX);
+            quadro[3] = amostra->cor.identificacao.confianca;
+            escrever_u32(quadro + 4, amostra->sequencia);
+            escrever_u32(quadro + 8, (uint32_t)amostra->tempo_us);
+            escrever_u16(quadro + 12, amostra->cor.identificacao.candidatas[0].indice);
+            memcpy(quadro + 14, amostra->cor.rgb_modos, sizeof(amostra->cor.rgb_modos));
+            memcpy(quadro + 14 + sizeof(amostra->cor.rgb_modos), amostra->cor.rgb_daltonizado,
+                   sizeof(amostra->cor.rgb_daltonizado));
+        }
+        // Com o buffer de envio cheio (cliente lento), esta amostra fica de fora
+        enviar_quadro(c, OP_BINARIO, quadro, sizeof(quadro));
+    }
+}
+
+int canal_websocket_clientes(void) {
+    int n = 0;
+    for (int i = 0; i < WEBSOCKET_MAX_CLIENTES; i++) {
+        n += clientes[i].pcb != NULL;
+    }
+    return n;
+}
@@ -0,0 +1,53 @@
+// canal_websocket.h
+#ifndef CANAL_WEBSOCKET_H
+#define CANAL_WEBSOCKET_H
+
+#include <stdbool.h>
+
+#include "lwip/tcp.h"
+#include "shared_data.h" // amostra_cor_t
+
+// WebSocket (RFC 6455) em GET /ws, na mesma porta 80: telemetria binária para o
+// cliente e comandos do cliente para o aparelho. Roda só no Core 1.
+//
+// Quadros binários do aparelho (inteiros little-endian):
+//   Amostra  [0]=WEBSOCKET_AMOSTRA, [1]=modo (0=Normal, n=tipo n-1), [2]=severidade (%),
+//            [3]=confiança (%), [4..7]=sequência, [8..11]=tempo_us (32 bits baixos),
+//            [12..13]=índice da cor na paleta, depois (DALTONISMO_NUM_TIPOS + 1) x RGB
+//            simulados e (DALTONISMO_NUM_TIPOS + 1) x RGB corrigidos.
+//   Resposta [0]=WEBSOCKET_RESPOSTA, [1]=comando, [2]=1 aceito / 0 recusado.
+// Comandos do cliente (quadros binários de 2 bytes: comando, valor):
+//   WEBSOCKET_CMD_MODO       modo 0..DALTONISMO_NUM_TIPOS, como no quadro de amostra
+//   WEBSOCKET_CMD_SEVERIDADE 0..100 (%), arredondada para o passo de 10%
+//   WEBSOCKET_CMD_INTERVALO  uma amostra a cada N enviadas a este cliente (0 = pausa)
+
+#define WEBSOCKET_AMOSTRA 0x01
+#define WEBSOCKET_RESPOSTA 0x02
+
+#define WEBSOCKET_CMD_MODO 0x01
+#define WEBSOCKET_CMD_SEVERIDADE 0x02
+#define WEBSOCKET_CMD_INTERVALO 0x03
+
+#define WEBSOCKET_MAX_CLIENTES 2
+
+/**
+ * @brief Responde ao handshake de GET /ws e assume a conexão.
+ * @param chave_cliente Valor do cabeçalho Sec-WebSocket-Key do pedido.
+ * @param resto Bytes recebidos depois do pedido (NULL = nenhum). São copiados, não
+ *              consumidos: o pbuf e o tcp_recved continuam com quem chamou.
+ * @return false se a chave falta, não há lugar ou 'resto' passa de um quadro; a
+ *         conexão continua com quem chamou.
+ */
+bool canal_websocket_aceitar(struct tcp_pcb *pcb, const char *chave_cliente, const struct pbuf *resto);
+
+/**
+ * @brief Codifica a amostra uma vez e a envia aos clientes, cada um no seu intervalo.
+ */
+void canal_websocket_enviar_amostra(const amostra_cor_t *amostra);
+
+/**
+ * @brief Clientes conectados agora.
+ */
+int canal_websocket_clientes(void);
+
+#endif // CANAL_WEBSOCKET_H
@@ -2,8 +2,11 @@
 
 #include "config.h"       // Inclui o próprio cabeçalho
 #include "tcs34725.h"     // Driver do sensor de cor TCS34725
+#include "controle_exposicao.h" // Ganho e tempo de integração automáticos
 #include "inc/ssd1306.h"  // Driver do OLED SSD1306
 #include "inc/ssd1306_i2c.h" // Driver OLED para I2C
+#include "i2c_dma_rp2040.h" // Motor I2C assíncrono (DMA)
+#include "tabelas_filtros.h" // Nomes e quantidade dos tipos de daltonismo (gerado)
 
 #include "hardware/adc.h" // Necessário para adc_init() e adc_gpio_init()
 #include "hardware/gpio.h" // Já deve estar presente, mas garante funções GPIO
@@ -17,14 +20,11 @@ const uint I2C_SDA_PIN_COR = 0;
 const uint I2C_SCL_PIN_COR = 1;
 
 volatile EstadoPrograma estado_atual = ESTADO_MENU_DALTONISMO; // O programa sempre começa no menu
-int opcao_selecionada_menu = 0;                                           // Índice da opção atualmente selecionada (0 = "Protanopia")
+int opcao_selecionada_menu = 0;                                           // Índice da opção atualmente selecionada (um tipo_daltonismo_t, ou a severidade logo depois)
 
-const char *menu_opcoes[] = {
-    "Protanopia",
-    "Deuteranopia",
-    "Tritanopia"
-};
-const int NUM_OPCOES_MENU = sizeof(menu_opcoes) / sizeof(menu_opcoes[0]);
+// O menu lista os tipos de daltonismo gerados no build (tools/gerar_tabelas_filtros.py)
+const char *const *menu_opcoes = daltonismo_nomes;
+const int NUM_OPCOES_MENU = DALTONISMO_NUM_TIPOS;
 
 volatile absolute_time_t ultimo_clique_btn5 = {0}; // Inicializa aqui
 volatile bool flag = false;
@@ -68,6 +68,10 @@ void iniciar_sistema()
     gpio_pull_up(OLED_SDA_PIN);
     gpio_pull_up(OLED_SCL_PIN);
 
+    // --- Motor I2C assíncrono (DMA) para os dois barramentos ---
+    // Precisa vir depois de i2c_init(): sensor e OLED passam a usar o DMA.
+    i2c_dma_rp2040_init();
+
     // --- Inicialização do Joystick (ADC e GPIOs digitais) ---
     adc_init();
     adc_gpio_init(JOYSTICK_VRY_PIN); // Apenas o Eixo Y
@@ -85,16 +89,23 @@ void iniciar_sistema()
     gpio_set_irq_enabled_with_callback(BOTAO, GPIO_IRQ_EDGE_FALL, true, &btn5_callback);
 
     // --- Inicialização do Sensor de Cor TCS34725 ---
-    uint8_t meu_atime = 0xEB; // Tempo de integração (ajuste conforme necessário)
-    uint8_t meu_ganho = 0x00; // Ganho (0x00 = 1x, 0x01 = 4x, 0x02 = 16x, 0x03 = 60x)
+    // Exposição inicial; depois o controle automático (AGC/AEC) ajusta ATIME e ganho
+    // a cada quadro a partir do canal clear.
+    controle_exposicao_init();
+    exposicao_t exposicao = controle_exposicao_atual();
 
     printf("Inicializando sensor de cor TCS34725...\n");
-    if (!tcs34725_init(I2C_PORT_COR, meu_atime, meu_ganho))
+    if (!tcs34725_init(I2C_PORT_COR, exposicao.atime, exposicao.ganho))
     {
         printf("ERRO: Falha ao inicializar o sensor TCS34725.\n");
         // Em um sistema real, você pode querer adicionar um LED de erro ou travar aqui.
         while (1);
     }
+    // Cada leitura passa a aguardar o fim de uma conversão do sensor (sem duplicatas).
+    if (!tcs34725_enable_sync(I2C_PORT_COR, SENSOR_COR_INT_PIN))
+    {
+        printf("ERRO: Falha ao habilitar a aquisicao sincronizada do TCS34725.\n");
+    }
 
     // --- Inicialização do OLED SSD1306 ---
     ssd1306_init();
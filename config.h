@@ -12,6 +12,9 @@
 #define I2C_PORT_COR i2c0
 extern const uint I2C_SDA_PIN_COR;
 extern const uint I2C_SCL_PIN_COR;
+// GPIO ligado ao pino INT do TCS34725. Com -1 (INT não ligado), o fim de cada
+// conversão é detectado consultando o registrador STATUS do sensor.
+#define SENSOR_COR_INT_PIN -1
 
 // Configuração I2C para o OLED
 #define I2C_PORT_OLED i2c1
@@ -27,8 +30,11 @@ extern const uint I2C_SCL_PIN_COR;
 #define JOYSTICK_THRESHOLD_HIGH 3500 // Leitura ADC acima deste valor (ex: para cima)
 #define JOYSTICK_THRESHOLD_LOW 500  // Leitura ADC abaixo deste valor (ex: para baixo)
 
-// Constante para o número de leituras para a média (para leitura do sensor de cor)
-#define NUM_LEITURAS_MEDIA 5
+// Filtro das leituras do sensor de cor (ver filtro_amostras.h): cada conversão nova
+// entra no histórico e gera uma saída suavizada, sem esperar juntar várias leituras.
+#define FILTRO_COR_MODO FILTRO_REJEITA_OUTLIERS // FILTRO_EMA, FILTRO_MEDIANA ou FILTRO_REJEITA_OUTLIERS
+#define FILTRO_COR_JANELA 5                     // Amostras na janela (mediana/rejeição)
+#define FILTRO_COR_ALFA_Q8 77                   // Peso da amostra nova na EMA (77/256 ~ 0.3)
 
 // Tempo de debounce em milissegundos para botões e joystick
 // Manter DEBOUNCE_MS em config.h, pois é uma constante usada para debounce.
@@ -37,16 +43,14 @@ extern const uint I2C_SCL_PIN_COR;
 // --- Estados do Programa (para a máquina de estados) ---
 typedef enum
 {
-    ESTADO_MENU_DALTONISMO,      // Estado inicial: seleção do tipo de daltonismo
-    ESTADO_ANALISE_PROTANOPIA,   // Estado de análise com filtro de protanopia
-    ESTADO_ANALISE_DEUTERANOPIA, // Estado de análise com filtro de deuteranopia
-    ESTADO_ANALISE_TRITANOPIA    // Estado de análise com filtro de tritanopia
+    ESTADO_MENU_DALTONISMO, // Estado inicial: seleção do tipo de daltonismo
+    ESTADO_ANALISE          // Análise com o filtro do tipo escolhido (opcao_selecionada_menu)
 } EstadoPrograma;
 
 // --- Variáveis Globais (declaradas como extern para serem acessíveis externamente) ---
 extern volatile EstadoPrograma estado_atual;
 extern int opcao_selecionada_menu;
-extern const char *menu_opcoes[]; // As opções do menu
+extern const char *const *menu_opcoes; // As opções do menu: um tipo de daltonismo cada
 extern const int NUM_OPCOES_MENU; // O número de opções do menu
 
 extern volatile absolute_time_t ultimo_clique_btn5;
@@ -0,0 +1,124 @@
+// controle_exposicao.c
+#include "controle_exposicao.h"
+
+// Tempos de integração candidatos, em ciclos de 2.4 ms (ATIME = 256 - ciclos),
+// do mais curto (9.6 ms) ao mais longo (614.4 ms).
+static const uint16_t ciclos_integracao[] = {4, 10, 21, 42, 84, 168, 256};
+#define NUM_TEMPOS (sizeof(ciclos_integracao) / sizeof(ciclos_integracao[0]))
+
+// Multiplicador de cada código de ganho do registrador CONTROL.
+static const uint8_t multiplicador_ganho[] = {1, 4, 16, 60};
+#define NUM_GANHOS (sizeof(multiplicador_ganho) / sizeof(multiplicador_ganho[0]))
+
+// Faixa desejada para o clear, em porcentagem do fundo de escala.
+#define ALVO_MIN_PCT 25
+#define ALVO_MAX_PCT 75
+// Fora desta faixa a exposição atual é abandonada mesmo sem ganho de taxa.
+#define HISTERESE_MIN_PCT 10
+#define HISTERESE_MAX_PCT 90
+// Acima disto o canal é considerado saturado (a irradiância real pode ser bem maior).
+#define SATURACAO_PCT 95
+// Contagem mínima do clear para uma relação sinal/ruído aceitável.
+#define CLEAR_MINIMO 1000
+
+static exposicao_t exposicao = {.atime = 0xEB, .ganho = 0x00};
+
+// Contagem máxima de cada canal com 'ciclos' de integração: 1024 por ciclo, até 65535.
+static uint32_t fundo_escala_ciclos(uint32_t ciclos) {
+    uint32_t fundo_escala = ciclos * 1024u;
+    return fundo_escala > 65535u ? 65535u : fundo_escala;
+}
+
+static exposicao_t montar_exposicao(uint32_t ciclos, uint8_t ganho) {
+    exposicao_t e = {.atime = (uint8_t)(256u - ciclos), .ganho = ganho};
+    return e;
+}
+
+void controle_exposicao_init(void) {
+    exposicao = montar_exposicao(21, 0); // 50.4 ms, ganho 1x
+}
+
+exposicao_t controle_exposicao_atual(void) {
+    return exposicao;
+}
+
+// Um canal: bruto * escala, com a escala em Q16. Abaixo do limite o produto fica
+// abaixo de 255 << 16 e cabe em 32 bits.
+static inline uint8_t normalizar_canal(uint16_t bruto, uint32_t limite, uint32_t escala_q16) {
+    if (bruto >= limite) {
+        return 255;
+    }
+    return (uint8_t)((bruto * escala_q16) >> 16);
+}
+
+void controle_exposicao_normalizar_rgb(uint16_t r_bruto, uint16_t g_bruto, uint16_t b_bruto, uint16_t clear,
+                                       uint8_t *r_normalizado, uint8_t *g_normalizado, uint8_t *b_normalizado) {
+    if (clear == 0) {
+        *r_normalizado = *g_normalizado = *b_normalizado = 0;
+        return;
+    }
+    // escala = 255 / clear, em Q16 (255 << 16 cabe em 32 bits).
+    uint32_t escala_q16 = (255u << 16) / clear;
+    // Menor contagem que satura em 255
+    uint32_t limite = ((255u << 16) + escala_q16 - 1) / escala_q16;
+
+    *r_normalizado = normalizar_canal(r_bruto, limite, escala_q16);
+    *g_normalizado = normalizar_canal(g_bruto, limite, escala_q16);
+    *b_normalizado = normalizar_canal(b_bruto, limite, escala_q16);
+}
+
+bool controle_exposicao_atualizar(uint16_t clear) {
+    uint32_t ciclos_atual = 256u - exposicao.atime;
+    uint32_t fundo_escala_atual = fundo_escala_ciclos(ciclos_atual);
+    uint32_t sensibilidade_atual = ciclos_atual * multiplicador_ganho[exposicao.ganho];
+
+    // Irradiância estimada (Q8), em contagens por unidade de sensibilidade.
+    uint64_t irradiancia = ((uint64_t)clear << 8) / sensibilidade_atual;
+    if ((uint64_t)clear * 100 >= (uint64_t)fundo_escala_atual * SATURACAO_PCT) {
+        // Saturado: a estimativa é só um limite inferior; salta 4x para baixo de uma vez.
+        irradiancia *= 4;
+    }
+
+    // Procura a menor integração que leva o clear para a faixa útil, com o maior
+    // ganho que não passe do limite superior.
+    bool encontrou = false;
+    exposicao_t escolhida = exposicao;
+    for (uint32_t t = 0; t < NUM_TEMPOS && !encontrou; t++) {
+        uint32_t ciclos = ciclos_integracao[t];
+        uint32_t fundo_escala = fundo_escala_ciclos(ciclos);
+        for (int g = NUM_GANHOS - 1; g >= 0; g--) {
+            uint64_t previsto = (irradiancia * ciclos * multiplicador_ganho[g]) >> 8;
+            if (previsto * 100 > (uint64_t)fundo_escala * ALVO_MAX_PCT) {
+                continue; // Saturaria: tenta um ganho menor
+            }
+            if (previsto * 100 >= (uint64_t)fundo_escala * ALVO_MIN_PCT && previsto >= CLEAR_MINIMO) {
+                escolhida = montar_exposicao(ciclos, (uint8_t)g);
+                encontrou = true;
+            }
+            break; // Ganhos menores só diminuem o sinal neste tempo
+        }
+    }
+
+    if (!encontrou) {
+        // Nenhuma combinação cai na faixa: luz demais ou de menos para o sensor.
+        uint64_t previsto_minimo = (irradiancia * ciclos_integracao[0]) >> 8;
+        if (previsto_minimo * 100 > (uint64_t)fundo_escala_ciclos(ciclos_integracao[0]) * ALVO_MAX_PCT) {
+            escolhida = montar_exposicao(ciclos_integracao[0], 0);
+        } else {
+            escolhida = montar_exposicao(ciclos_integracao[NUM_TEMPOS - 1], NUM_GANHOS - 1);
+        }
+    }
+
+    // Histerese: dentro da faixa larga, só troca se a nova integração for mais curta.
+    bool dentro_da_faixa = (uint64_t)clear * 100 >= (uint64_t)fundo_escala_atual * HISTERESE_MIN_PCT &&
+                           (uint64_t)clear * 100 <= (uint64_t)fundo_escala_atual * HISTERESE_MAX_PCT &&
+                           clear >= CLEAR_MINIMO;
+    if (dentro_da_faixa && (256u - escolhida.atime) >= ciclos_atual) {
+        return false;
+    }
+    if (escolhida.atime == exposicao.atime && escolhida.ganho == exposicao.ganho) {
+        return false;
+    }
+    exposicao = escolhida;
+    return true;
+}
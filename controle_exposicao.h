@@ -0,0 +1,51 @@
+// controle_exposicao.h
+#ifndef CONTROLE_EXPOSICAO_H
+#define CONTROLE_EXPOSICAO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Configuração de exposição do TCS34725
+typedef struct {
+    uint8_t atime; // Registrador ATIME: integração de (256 - atime) * 2.4 ms
+    uint8_t ganho; // Código do registrador CONTROL (0 = 1x, 1 = 4x, 2 = 16x, 3 = 60x)
+} exposicao_t;
+
+/**
+ * @brief Volta o controle à exposição inicial (50.4 ms, ganho 1x).
+ */
+void controle_exposicao_init(void);
+
+/**
+ * @brief Exposição que deve estar programada no sensor.
+ */
+exposicao_t controle_exposicao_atual(void);
+
+/**
+ * @brief Leva as contagens brutas para a escala 0-255 da paleta, relativas ao canal clear.
+ *
+ * Cada canal vale 255 * canal / clear (255 quando o canal alcança o clear, que
+ * recebe toda a luz visível). As quatro contagens vêm da mesma conversão: o tempo
+ * de integração, o ganho e a intensidade da luz ambiente se cancelam, e sobra a
+ * proporção entre os canais. A exposição não define a faixa da saída; o controle
+ * só cuida da relação sinal/ruído e de manter o clear fora da saturação.
+ * Só aritmética inteira: uma divisão por chamada para a escala em Q16, outra para o limite.
+ * @param clear Canal clear da mesma amostra (0 dá preto).
+ */
+void controle_exposicao_normalizar_rgb(uint16_t r_bruto, uint16_t g_bruto, uint16_t b_bruto, uint16_t clear,
+                                       uint8_t *r_normalizado, uint8_t *g_normalizado, uint8_t *b_normalizado);
+
+/**
+ * @brief Ajusta a exposição (AGC/AEC) a partir do canal clear.
+ *
+ * Estima a irradiância a partir de 'clear' (lido com a exposição atual) e
+ * escolhe diretamente a combinação de ATIME e ganho que leva o clear para a
+ * faixa útil, sem subir/descer um degrau por vez. Entre as combinações
+ * possíveis, prefere o menor tempo de integração: com luz suficiente, a taxa
+ * de amostras sobe sozinha.
+ * @param clear Valor do canal clear (média das leituras do quadro).
+ * @return true se a exposição mudou e precisa ser programada no sensor.
+ */
+bool controle_exposicao_atualizar(uint16_t clear);
+
+#endif // CONTROLE_EXPOSICAO_H
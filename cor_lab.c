@@ -0,0 +1,132 @@
+// cor_lab.c
+#include "cor_lab.h"
+#include "tabelas_cores.h" // Tabelas de conversão geradas no build
+#include <math.h>
+
+#define LINEAR_BITS 15    // sRGB linear e t = X/Xn em Q15
+#define RAIZ_PASSO_BITS 5 // Uma entrada de lab_raiz_cubica a cada 32 passos de t
+
+static const float PI_F = 3.14159265f;
+
+// f(t) do CIELAB (raiz cúbica, com o trecho linear perto do preto) em Q15.
+static int32_t lab_f_q15(int32_t t)
+{
+    if (t < 0)
+    {
+        t = 0;
+    }
+    int32_t limite = ((LAB_RAIZ_ENTRADAS - 1) << RAIZ_PASSO_BITS) - 1;
+    if (t > limite)
+    {
+        t = limite;
+    }
+    int32_t i = t >> RAIZ_PASSO_BITS;
+    int32_t frac = t & ((1 << RAIZ_PASSO_BITS) - 1);
+    int32_t y0 = lab_raiz_cubica[i];
+    int32_t y1 = lab_raiz_cubica[i + 1];
+    return y0 + (((y1 - y0) * frac) >> RAIZ_PASSO_BITS);
+}
+
+void cor_lab_de_rgb(uint8_t r, uint8_t g, uint8_t b, cor_lab_t *lab)
+{
+    int32_t linear[3] = {lab_srgb_linear[r], lab_srgb_linear[g], lab_srgb_linear[b]};
+    int32_t f[3];
+    for (int i = 0; i < 3; i++)
+    {
+        // Q15 * Q14 = Q29, cabe em 32 bits (a soma de cada linha é 1.0).
+        int32_t t = (linear[0] * lab_matriz[i][0] + linear[1] * lab_matriz[i][1] + linear[2] * lab_matriz[i][2] +
+                     (1 << 13)) >> 14;
+        f[i] = lab_f_q15(t);
+    }
+
+    // L = 116 fy - 16, a = 500 (fx - fy), b = 200 (fy - fz), já na escala COR_LAB_ESCALA.
+    const int32_t meio = 1 << (LINEAR_BITS - 1);
+    lab->l = (int16_t)(((116 * COR_LAB_ESCALA * f[1] + meio) >> LINEAR_BITS) - 16 * COR_LAB_ESCALA);
+    lab->a = (int16_t)((500 * COR_LAB_ESCALA * (f[0] - f[1]) + meio) >> LINEAR_BITS);
+    lab->b = (int16_t)((200 * COR_LAB_ESCALA * (f[1] - f[2]) + meio) >> LINEAR_BITS);
+}
+
+// Ângulo de matiz em graus, no intervalo [0, 360).
+static float matiz_graus(float b, float a)
+{
+    if (a == 0.0f && b == 0.0f)
+    {
+        return 0.0f;
+    }
+    float h = atan2f(b, a) * (180.0f / PI_F);
+    return (h < 0.0f) ? h + 360.0f : h;
+}
+
+static float radianos(float graus)
+{
+    return graus * (PI_F / 180.0f);
+}
+
+// CIEDE2000 conforme Sharma, Wu e Dalal (2005), com kL = kC = kH = 1.
+float cor_lab_delta_e2000(const cor_lab_t *x, const cor_lab_t *y)
+{
+    const float escala = 1.0f / COR_LAB_ESCALA;
+    float l1 = x->l * escala, a1 = x->a * escala, b1 = x->b * escala;
+    float l2 = y->l * escala, a2 = y->a * escala, b2 = y->b * escala;
+
+    float c_medio = 0.5f * (sqrtf(a1 * a1 + b1 * b1) + sqrtf(a2 * a2 + b2 * b2));
+    float c7 = c_medio * c_medio * c_medio;
+    c7 = c7 * c7 * c_medio;
+    float g = 0.5f * (1.0f - sqrtf(c7 / (c7 + 6103515625.0f))); // 25^7
+
+    float a1p = (1.0f + g) * a1;
+    float a2p = (1.0f + g) * a2;
+    float c1p = sqrtf(a1p * a1p + b1 * b1);
+    float c2p = sqrtf(a2p * a2p + b2 * b2);
+    float h1p = matiz_graus(b1, a1p);
+    float h2p = matiz_graus(b2, a2p);
+
+    float dlp = l2 - l1;
+    float dcp = c2p - c1p;
+    float dhp = 0.0f;
+    if (c1p * c2p != 0.0f)
+    {
+        dhp = h2p - h1p;
+        if (dhp > 180.0f)
+        {
+            dhp -= 360.0f;
+        }
+        else if (dhp < -180.0f)
+        {
+            dhp += 360.0f;
+        }
+    }
+    float dHp = 2.0f * sqrtf(c1p * c2p) * sinf(radianos(dhp * 0.5f));
+
+    float lp_medio = 0.5f * (l1 + l2);
+    float cp_medio = 0.5f * (c1p + c2p);
+    float hp_medio = h1p + h2p;
+    if (c1p * c2p != 0.0f)
+    {
+        if (fabsf(h1p - h2p) <= 180.0f)
+        {
+            hp_medio *= 0.5f;
+        }
+        else
+        {
+            hp_medio = (hp_medio < 360.0f) ? 0.5f * (hp_medio + 360.0f) : 0.5f * (hp_medio - 360.0f);
+        }
+    }
+
+    float t = 1.0f - 0.17f * cosf(radianos(hp_medio - 30.0f)) + 0.24f * cosf(radianos(2.0f * hp_medio)) +
+              0.32f * cosf(radianos(3.0f * hp_medio + 6.0f)) - 0.20f * cosf(radianos(4.0f * hp_medio - 63.0f));
+    float dtheta = 30.0f * expf(-((hp_medio - 275.0f) / 25.0f) * ((hp_medio - 275.0f) / 25.0f));
+    float cp7 = cp_medio * cp_medio * cp_medio;
+    cp7 = cp7 * cp7 * cp_medio;
+    float rc = 2.0f * sqrtf(cp7 / (cp7 + 6103515625.0f));
+    float l50 = (lp_medio - 50.0f) * (lp_medio - 50.0f);
+    float sl = 1.0f + (0.015f * l50) / sqrtf(20.0f + l50);
+    float sc = 1.0f + 0.045f * cp_medio;
+    float sh = 1.0f + 0.015f * cp_medio * t;
+    float rt = -sinf(radianos(2.0f * dtheta)) * rc;
+
+    float tl = dlp / sl;
+    float tc = dcp / sc;
+    float th = dHp / sh;
+    return sqrtf(tl * tl + tc * tc + th * th + rt * tc * th);
+}
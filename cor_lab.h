@@ -0,0 +1,44 @@
+// cor_lab.h
+// Conversão sRGB -> CIELAB em ponto fixo e distâncias perceptivas (ΔE).
+// As tabelas da conversão são geradas no build (tools/gerar_tabelas_cores.py).
+#ifndef COR_LAB_H
+#define COR_LAB_H
+
+#include <stdint.h>
+
+#define COR_LAB_ESCALA 64 // L, a, b em 1/64 de unidade
+
+// Cor no espaço CIELAB (iluminante D65), em 1/COR_LAB_ESCALA de unidade.
+typedef struct {
+    int16_t l, a, b;
+} cor_lab_t;
+
+/**
+ * @brief Converte uma cor sRGB (0-255) para CIELAB, só com aritmética inteira.
+ *
+ * A raiz cúbica vem de uma tabela interpolada; o erro em relação ao cálculo em
+ * float fica abaixo de 0.2 ΔE (o maior é perto do preto, pela resolução Q15).
+ */
+void cor_lab_de_rgb(uint8_t r, uint8_t g, uint8_t b, cor_lab_t *lab);
+
+/**
+ * @brief ΔE76 ao quadrado, na escala de COR_LAB_ESCALA ao quadrado.
+ *
+ * Barato (inteiro, sem raiz): serve para ordenar e pré-filtrar candidatas.
+ */
+static inline uint32_t cor_lab_delta_e76_2(const cor_lab_t *x, const cor_lab_t *y)
+{
+    int32_t dl = x->l - y->l;
+    int32_t da = x->a - y->a;
+    int32_t db = x->b - y->b;
+    return (uint32_t)(dl * dl + da * da + db * db);
+}
+
+/**
+ * @brief ΔE2000 (CIEDE2000) entre duas cores, em unidades de ΔE.
+ *
+ * Exato, mas usa float e trigonometria: reservar para poucas candidatas.
+ */
+float cor_lab_delta_e2000(const cor_lab_t *x, const cor_lab_t *y);
+
+#endif // COR_LAB_H
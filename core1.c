@@ -4,7 +4,6 @@
 
 #include "pico/cyw43_arch.h"
 #include "pico/stdlib.h"
-#include "pico/sync.h"   // Para mutex
 
 #include "lwip/pbuf.h"
 #include "lwip/tcp.h"
@@ -16,6 +15,12 @@
 
 // Incluir o cabeçalho com as variáveis compartilhadas
 #include "shared_data.h"
+#include "tabelas_cores.h" // Nomes das cores candidatas
+#include "filtros_daltonismo.h" // Nomes dos tipos de daltonismo e severidades
+#include "eventos_sse.h" // GET /events
+#include "canal_websocket.h" // GET /ws
+#include "analisador_http.h"
+#include "ativos_web.h" // Página, JS e CSS comprimidos, gerados no build a partir de web/
 
 // --- Definições do Access Point (AP) ---
 // Você pode mudar esses valores para o nome e senha da sua rede Wi-Fi que o Pico vai criar.
@@ -25,167 +30,624 @@
 #define TCP_PORT 80
 #define DEBUG_printf printf
 
-// --- Variáveis globais para os dados compartilhados (definições) ---
-// Estes são os locais de armazenamento reais das variáveis declaradas como 'extern' em shared_data.h
-volatile uint8_t shared_r_corrigido = 0;
-volatile uint8_t shared_g_corrigido = 0;
-volatile uint8_t shared_b_corrigido = 0;
-volatile char shared_color_name[32] = "Aguardando Leitura..."; // Valor inicial
-volatile int shared_daltonism_mode = 0; // 0=Normal
-
-// Definição do mutex
-mutex_t shared_data_mutex;
-
 // --- Estruturas e Funções do Servidor TCP (adaptadas de picow_access_point.c) ---
 typedef struct TCP_SERVER_T_ {
     struct tcp_pcb *tcp_server_pcb;
-    struct tcp_pcb *tcp_client_pcb;
-    bool complete;
     ip_addr_t gw;
     ip_addr_t netmask;
 } TCP_SERVER_T;
 
 static TCP_SERVER_T *tcp_server_state;
 
-static err_t tcp_server_close(void *arg) {
-    TCP_SERVER_T *state = (TCP_SERVER_T*)arg;
-    err_t err = ERR_OK; 
-
-    if (state->tcp_client_pcb) {
-        tcp_arg(state->tcp_client_pcb, NULL);
-        tcp_sent(state->tcp_client_pcb, NULL);
-        tcp_recv(state->tcp_client_pcb, NULL);
-        tcp_err(state->tcp_client_pcb, NULL);
-        tcp_poll(state->tcp_client_pcb, NULL, 0); // Desabilita o polling para este PCB de cliente
-
-        err = tcp_close(state->tcp_client_pcb); // Fecha APENAS o PCB do cliente
-        if (err != ERR_OK) {
-            DEBUG_printf("Failed to close client pcb %d\n", err);
-            tcp_abort(state->tcp_client_pcb); // Abortar se fechar falhar (isto é para tratamento de erros)
-            return ERR_ABRT; // Use ERR_ABRT para abort, se aplicável
-        }
-        state->tcp_client_pcb = NULL; // Limpa o ponteiro para o cliente
+// --- Conexões HTTP ---
+// Um contexto por conexão, num pool fixo: um por cliente que o DHCP pode atender.
+// Com o pool cheio, a conexão nova toma o lugar da que está há mais tempo sem atividade.
+// As conexões são persistentes (keep-alive): vários pedidos, um de cada vez.
+#define HTTP_MAX_CONEXOES DHCPS_MAX_IP
+#define HTTP_TAMANHO_RESPOSTA 3072 // Cabeçalhos e corpo dos JSON (o maior é /api/historico)
+// Sem atividade por este tempo, a conexão é fechada. O tcp_poll conta de 500 em 500 ms.
+#define HTTP_INTERVALO_POLL 2 // 1 s
+#define HTTP_POLLS_OCIOSA 10  // 10 s
+
+typedef struct {
+    struct tcp_pcb *pcb; // NULL = lugar livre
+    analisador_http_t pedido;
+    // Recebido e ainda não analisado. Enquanto uma resposta sai, o pedido seguinte
+    // (pipelining) espera aqui, e a janela TCP só reabre (tcp_recved) quando ele é lido.
+    struct pbuf *recebido;
+    // A resposta fica aqui até o ACK: o tcp_write não copia, só aponta para ela.
+    // Arquivos da página: só os cabeçalhos ficam aqui; o corpo sai direto da flash.
+    char resposta[HTTP_TAMANHO_RESPOSTA];
+    uint16_t resposta_len; // 0 = nenhuma resposta em andamento
+    const uint8_t *flash;  // Corpo em flash, enviado depois de 'resposta' (NULL = nenhum)
+    uint32_t flash_len;
+    uint32_t escrito;    // Entregue ao lwIP, contando 'resposta' e depois 'flash'
+    uint32_t confirmado; // Confirmado pelo cliente (ACK)
+    bool manter;         // Continua aberta depois desta resposta
+    uint8_t polls_ociosa;
+    uint64_t ultimo_uso_us; // Para a substituição LRU
+} conexao_http_t;
+
+static conexao_http_t conexoes[HTTP_MAX_CONEXOES];
+
+static void conexao_processar(conexao_http_t *c);
+
+static void conexao_tocar(conexao_http_t *c) {
+    c->polls_ociosa = 0;
+    c->ultimo_uso_us = time_us_64();
+}
+
+// Solta o lugar no pool sem mexer no pcb (fechado, abortado ou entregue a outro módulo).
+static void conexao_liberar(conexao_http_t *c) {
+    c->pcb = NULL;
+    if (c->recebido) {
+        pbuf_free(c->recebido);
+        c->recebido = NULL;
     }
+}
 
-    return err; // Retorna o status de fechamento do cliente
+// Entrega a conexão a outro módulo. O que chegou depois do pedido e ainda não foi
+// lido é confirmado ao lwIP (tcp_recved) antes de ser descartado: sem isso, a
+// janela de recepção do pcb ficaria menor para sempre.
+static void conexao_entregar(conexao_http_t *c) {
+    if (c->recebido) {
+        tcp_recved(c->pcb, c->recebido->tot_len);
+    }
+    conexao_liberar(c);
 }
 
-static err_t tcp_server_sent(void *arg, struct tcp_pcb *tpcb, u16_t len) {
-    TCP_SERVER_T *state = (TCP_SERVER_T*)arg;
-    DEBUG_printf("tcp_server_sent %u (dados enviados e reconhecidos)\n", len);
+// Desfaz os callbacks e fecha; devolve true se o pcb foi abortado
+// (o callback do lwIP que chamou deve então devolver ERR_ABRT).
+static bool conexao_fechar(conexao_http_t *c) {
+    struct tcp_pcb *pcb = c->pcb;
+    conexao_liberar(c);
+    tcp_arg(pcb, NULL);
+    tcp_sent(pcb, NULL);
+    tcp_recv(pcb, NULL);
+    tcp_err(pcb, NULL);
+    tcp_poll(pcb, NULL, 0);
+    err_t err = tcp_close(pcb);
+    if (err != ERR_OK) {
+        DEBUG_printf("Failed to close client pcb %d\n", err);
+        tcp_abort(pcb);
+        return true;
+    }
+    return false;
+}
+
+static uint32_t conexao_total(const conexao_http_t *c) {
+    return c->resposta_len + c->flash_len;
+}
+
+// Entrega ao lwIP o quanto couber da resposta (TCP_SND_BUF e a fila de segmentos);
+// o resto sai em tcp_server_sent(), à medida que o cliente confirma.
+static void conexao_enviar(conexao_http_t *c) {
+    bool escreveu = false;
+    while (c->escrito < conexao_total(c)) {
+        const void *origem;
+        uint32_t restante;
+        if (c->escrito < c->resposta_len) {
+            origem = c->resposta + c->escrito;
+            restante = c->resposta_len - c->escrito;
+        } else {
+            origem = c->flash + (c->escrito - c->resposta_len);
+            restante = conexao_total(c) - c->escrito;
+        }
+        uint16_t cabe = tcp_sndbuf(c->pcb);
+        uint16_t n = restante < cabe ? restante : cabe;
+        if (n == 0) {
+            break;
+        }
+        bool mais = c->escrito + n < conexao_total(c);
+        if (tcp_write(c->pcb, origem, n, mais ? TCP_WRITE_FLAG_MORE : 0) != ERR_OK) {
+            break; // Fila de segmentos cheia: continua no próximo ACK
+        }
+        c->escrito += n;
+        escreveu = true;
+    }
+    if (escreveu) {
+        tcp_output(c->pcb);
+    }
+}
 
-    // Após todos os dados terem sido escritos e reconhecidos, fechamos a conexão.
-    // Este callback é acionado *após* o tcp_write anterior ter sido ACKed.
-    // Como estamos enviando toda a resposta HTTP em tcp_server_recv de uma vez,
-    // este `tcp_server_sent` significa que a resposta foi enviada e reconhecida.
-    return tcp_server_close(state);
+static err_t tcp_server_sent(void *arg, struct tcp_pcb *tpcb, u16_t len) {
+    conexao_http_t *c = (conexao_http_t *)arg;
+    conexao_tocar(c);
+    c->confirmado += len;
+    if (c->confirmado < conexao_total(c)) {
+        conexao_enviar(c);
+        return ERR_OK;
+    }
+    // Resposta inteira confirmada
+    if (!c->manter) {
+        return conexao_fechar(c) ? ERR_ABRT : ERR_OK;
+    }
+    c->resposta_len = 0;
+    c->flash_len = 0;
+    analisador_http_iniciar(&c->pedido);
+    conexao_processar(c); // Pedido que chegou enquanto esta resposta saía
+    return ERR_OK;
 }
 
 static void tcp_server_error(void *arg, err_t err) {
     if (err != ERR_ABRT) {
         DEBUG_printf("tcp_server_error %d\n", err);
     }
+    // O lwIP já liberou o pcb
+    conexao_http_t *c = (conexao_http_t *)arg;
+    if (c) {
+        conexao_liberar(c);
+    }
+}
+
+static err_t tcp_server_poll(void *arg, struct tcp_pcb *tpcb) {
+    conexao_http_t *c = (conexao_http_t *)arg;
+    if (++c->polls_ociosa >= HTTP_POLLS_OCIOSA) {
+        DEBUG_printf("Conexao ociosa encerrada\n");
+        return conexao_fechar(c) ? ERR_ABRT : ERR_OK;
+    }
+    // Resposta parada por falta de espaço no buffer de envio: tenta de novo
+    if (c->escrito < conexao_total(c)) {
+        conexao_enviar(c);
+    }
+    return ERR_OK;
 }
 
-// Função para gerar o HTML dinamicamente
-char* generate_color_html() {
-    static char http_response_content[512]; // Buffer para a resposta HTML
-    uint8_t r, g, b;
-    char color_name[32];
-    int daltonism_mode;
-    const char* daltonism_type_str = "";
-
-    // Proteger acesso aos dados compartilhados ao ler
-    mutex_enter_blocking(&shared_data_mutex);
-    r = shared_r_corrigido;
-    g = shared_g_corrigido;
-    b = shared_b_corrigido;
-    strncpy(color_name, (const char*)shared_color_name, sizeof(color_name) - 1);
-    color_name[sizeof(color_name) - 1] = '\0'; // Garantir terminação nula
-    daltonism_mode = shared_daltonism_mode;
-    mutex_exit(&shared_data_mutex);
-
-    // Mapear o modo de daltonismo para uma string legível
-    switch (daltonism_mode) {
-        case 1: daltonism_type_str = "Protanopia"; break;
-        case 2: daltonism_type_str = "Deuteranopia"; break;
-        case 3: daltonism_type_str = "Tritanopia"; break;
-        default: daltonism_type_str = "Normal"; break; // Caso 0 ou outro valor inesperado
-    }
-
-    // HTML muito simples, sem CSS externo, usando inline style para a cor de fundo.
-    // O meta refresh recarrega a página a cada segundo para exibir a cor mais recente.
-    snprintf(http_response_content, sizeof(http_response_content),
-             "<html>"
-             "<head>"
-             "<title>Coresenxergo</title>"
-             "<meta http-equiv=\"refresh\" content=\"2\">"
-             "</head>"
-             "<body style=\"background-color:rgb(%u,%u,%u); color:white; text-align:center; font-family:sans-serif;\">"
-             "<h1>Colorviz: Simulação de Daltonismo</h1>"
-             "<p>Modo de visualização: <b>%s</b></p>"
-             "<p>Cor Identificada: <b>%s</b></p>"
-             "<p>RGB: (%u, %u, %u)</p>"
-             "</body>"
-             "</html>",
-             r, g, b, daltonism_type_str, color_name, r, g, b);
-
-    return http_response_content;
+// 0 = Normal; n > 0 = tipo de daltonismo n - 1 ("Protanomalia" abaixo da severidade máxima).
+static const char *nome_modo_daltonismo(int daltonism_mode, int severidade) {
+    if (daltonism_mode >= 1 && daltonism_mode <= DALTONISMO_NUM_TIPOS) {
+        return nome_daltonismo((tipo_daltonismo_t)(daltonism_mode - 1), severidade);
+    }
+    return "Normal"; // Caso 0 ou outro valor inesperado
 }
 
-static err_t tcp_server_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err) {
-    TCP_SERVER_T *state = (TCP_SERVER_T*)arg;
-    if (!p) {
-        DEBUG_printf("tcp_server_recv: No pbuf, closing connection.\n");
-        return tcp_server_close(arg);
-    }
-    // Indicate that the pbuf has been received
-    tcp_recved(tpcb, p->tot_len);
-
-    if (err == ERR_OK) {
-        char *req_data = (char *)p->payload;
-        int req_len = p->tot_len;
-
-        // Simplificado: Assumimos que qualquer requisição é um GET e respondemos com a cor HTML.
-        // Em um servidor real, você verificaria o método HTTP e o caminho da URL.
-        if (req_len >= 3 && strncmp(req_data, "GET", 3) == 0) {
-            char *response_body = generate_color_html();
-            int body_len = strlen(response_body);
-
-            char http_response_headers[256];
-            snprintf(http_response_headers, sizeof(http_response_headers),
-                     "HTTP/1.1 200 OK\r\nContent-Length: %d\r\nContent-Type: text/html; charset=utf-8\r\nConnection: close\r\n\r\n",
-                     body_len);
-
-            // Envia cabeçalhos e corpo
-            err = tcp_write(tpcb, http_response_headers, strlen(http_response_headers), 1);
-            if (err == ERR_OK) {
-                err = tcp_write(tpcb, response_body, body_len, 1);
+// --- Amostras vindas do Core 0 ---
+// Tudo o que o Core 1 sabe da cor chega pelo anel (shared_data.h): a amostra mais
+// recente responde às requisições, as anteriores formam o histórico.
+#define HISTORICO_AMOSTRAS 16
+static amostra_cor_t historico[HISTORICO_AMOSTRAS];
+static uint32_t amostras_recebidas = 0;
+static uint32_t perdidas_relatadas = 0;
+
+static const amostra_cor_t *amostra_atual(void);
+static char *generate_event_json(void);
+
+// Retira do anel tudo o que o Core 0 publicou desde a última chamada.
+static void consumir_amostras(void) {
+    if (!anel_amostras_campainha()) {
+        return;
+    }
+    while (anel_amostras_retirar(&historico[amostras_recebidas % HISTORICO_AMOSTRAS])) {
+        // Toda amostra vai para o WebSocket assim que chega, não só a mais recente
+        canal_websocket_enviar_amostra(&historico[amostras_recebidas % HISTORICO_AMOSTRAS]);
+        amostras_recebidas++;
+    }
+    uint32_t perdidas = anel_amostras_perdidas();
+    if (perdidas != perdidas_relatadas) {
+        DEBUG_printf("Anel de amostras cheio: %lu amostras perdidas\n", (unsigned long)(perdidas - perdidas_relatadas));
+        perdidas_relatadas = perdidas;
+    }
+
+    // Um evento SSE por identidade nova: o que a página mostra só muda com ela.
+    static uint32_t versao_evento = 0;
+    uint32_t versao = amostra_atual()->cor.versao_identidade;
+    if (amostras_recebidas != 0 && versao != versao_evento) {
+        versao_evento = versao;
+        eventos_sse_publicar(versao, generate_event_json());
+    }
+}
+
+// Amostra mais recente; toda zerada (sequência 0) antes da primeira leitura do sensor.
+static const amostra_cor_t *amostra_atual(void) {
+    static const amostra_cor_t nenhuma = {0};
+    if (amostras_recebidas == 0) {
+        return &nenhuma;
+    }
+    return &historico[(amostras_recebidas - 1) % HISTORICO_AMOSTRAS];
+}
+
+// Lê o inteiro do parâmetro 'nome' (ex.: "valor=") na consulta do caminho.
+// Devolve false se o parâmetro não estiver lá ou não começar por um dígito.
+static bool ler_parametro(const char *dados, int len, const char *nome, int *valor) {
+    int n = strlen(nome);
+    for (int i = 0; i + n < len && dados[i] != '\r' && dados[i] != '\n'; i++) {
+        if ((dados[i] == '?' || dados[i] == '&') && memcmp(dados + i + 1, nome, n) == 0) {
+            int j = i + 1 + n;
+            if (j >= len || dados[j] < '0' || dados[j] > '9') {
+                return false;
             }
-            if (err == ERR_OK) {
-                tcp_output(tpcb); // Força o envio dos dados
+            int v = 0;
+            for (; j < len && dados[j] >= '0' && dados[j] <= '9' && v < 10000; j++) {
+                v = v * 10 + (dados[j] - '0');
             }
+            *valor = v;
+            return true;
         }
+    }
+    return false;
+}
+
+// GET /api/severidade?valor=N: N em porcentagem (0-100), arredondada para o passo de 10%.
+static bool definir_severidade_web(const char *dados, int len) {
+    int porcentagem;
+    if (!ler_parametro(dados, len, "valor=", &porcentagem) || porcentagem > 100) {
+        return false;
+    }
+    int severidade = (porcentagem * DALTONISMO_SEVERIDADE_MAX + 50) / 100;
+    shared_severidade = severidade; // Aplicada pelo Core 0 no próximo quadro
+    return true;
+}
+
+// Gera o JSON de /api/cor: cor identificada, confiança e alternativas.
+// 'versao' só muda quando a identidade muda; o cliente pode pular o redesenho
+// enquanto ela for a mesma. Os nomes da paleta não têm aspas nem '\\' (o gerador recusa).
+static char *generate_color_json(void) {
+    static char json[1024];
+    // Sequência da amostra que gerou 'json': se ela não mudou, o JSON também não.
+    static uint32_t sequencia_json = 0;
+    const amostra_cor_t *amostra = amostra_atual();
+    if (sequencia_json != 0 && amostra->sequencia == sequencia_json) {
+        return json;
+    }
+    sequencia_json = amostra->sequencia;
+
+    const identificacao_cor_t identificacao = amostra->cor.identificacao;
+    const uint8_t (*rgb_modos)[3] = amostra->cor.rgb_modos;
+    const uint8_t (*rgb_daltonizado)[3] = amostra->cor.rgb_daltonizado;
+    int daltonism_mode = amostra->cor.modo;
+    int severidade = amostra->cor.severidade;
+    uint32_t versao = amostra->cor.versao_identidade;
+    uint8_t r = rgb_modos[daltonism_mode][0];
+    uint8_t g = rgb_modos[daltonism_mode][1];
+    uint8_t b = rgb_modos[daltonism_mode][2];
+
+    int n = snprintf(json, sizeof(json),
+                     "{\"sequencia\":%lu,\"versao\":%lu,\"modo\":\"%s\",\"severidade\":%d,\"rgb\":[%u,%u,%u],\"modos\":[",
+                     (unsigned long)amostra->sequencia, (unsigned long)versao,
+                     nome_modo_daltonismo(daltonism_mode, severidade),
+                     severidade * 100 / DALTONISMO_SEVERIDADE_MAX, r, g, b);
+    // Todos os modos, na numeração de "modo" (0 = Normal), com a cor simulada e a corrigida
+    for (int m = 0; m <= DALTONISMO_NUM_TIPOS && n < (int)sizeof(json); m++) {
+        n += snprintf(json + n, sizeof(json) - n, "%s{\"modo\":\"%s\",\"rgb\":[%u,%u,%u],\"corrigida\":[%u,%u,%u]}",
+                      m ? "," : "", nome_modo_daltonismo(m, severidade),
+                      rgb_modos[m][0], rgb_modos[m][1], rgb_modos[m][2],
+                      rgb_daltonizado[m][0], rgb_daltonizado[m][1], rgb_daltonizado[m][2]);
+    }
+    if (n < (int)sizeof(json)) {
+        n += snprintf(json + n, sizeof(json) - n, "],\"confianca\":%u,\"ambigua\":%s,\"candidatas\":[",
+                      identificacao.confianca, identificacao.ambigua ? "true" : "false");
+    }
+    for (int i = 0; i < identificacao.quantidade && n < (int)sizeof(json); i++) {
+        const candidata_cor_t *c = &identificacao.candidatas[i];
+        n += snprintf(json + n, sizeof(json) - n, "%s{\"nome\":\"%s\",\"distancia\":%u.%02u}",
+                      i ? "," : "", tabelas_cores_nome(c->indice),
+                      c->distancia / IDENTIFICACAO_DISTANCIA_ESCALA,
+                      (c->distancia % IDENTIFICACAO_DISTANCIA_ESCALA) * 100 / IDENTIFICACAO_DISTANCIA_ESCALA);
+    }
+    if (n < (int)sizeof(json)) {
+        snprintf(json + n, sizeof(json) - n, "]}");
+    }
+    return json;
+}
+
+// Gera o JSON de /api/historico: as últimas amostras, da mais antiga para a mais recente.
+// Um salto na "sequencia" são amostras que o anel descartou.
+static char *generate_history_json(void) {
+    static char json[2560];
+    uint32_t quantidade = amostras_recebidas < HISTORICO_AMOSTRAS ? amostras_recebidas : HISTORICO_AMOSTRAS;
+    int n = snprintf(json, sizeof(json), "{\"perdidas\":%lu,\"amostras\":[", (unsigned long)anel_amostras_perdidas());
+    for (uint32_t i = 0; i < quantidade && n < (int)sizeof(json); i++) {
+        const amostra_cor_t *amostra = &historico[(amostras_recebidas - quantidade + i) % HISTORICO_AMOSTRAS];
+        const uint8_t *rgb = amostra->cor.rgb_modos[amostra->cor.modo];
+        n += snprintf(json + n, sizeof(json) - n,
+                      "%s{\"sequencia\":%lu,\"tempo_ms\":%lu,\"modo\":\"%s\",\"rgb\":[%u,%u,%u],\"nome\":\"%s\",\"confianca\":%u}",
+                      i ? "," : "", (unsigned long)amostra->sequencia, (unsigned long)(amostra->tempo_us / 1000),
+                      nome_modo_daltonismo(amostra->cor.modo, amostra->cor.severidade), rgb[0], rgb[1], rgb[2],
+                      tabelas_cores_nome(amostra->cor.identificacao.candidatas[0].indice),
+                      amostra->cor.identificacao.confianca);
+    }
+    if (n < (int)sizeof(json)) {
+        snprintf(json + n, sizeof(json) - n, "]}");
+    }
+    return json;
+}
+
+// Gera o evento SSE: só o que a página atualiza no lugar, sem quebras de linha.
+// "modos": [nome, r, g, b, r corrigido, g corrigido, b corrigido] por modo (0 = Normal).
+static char *generate_event_json(void) {
+    static char json[512];
+    const amostra_cor_t *amostra = amostra_atual();
+    int modo = amostra->cor.modo;
+    int severidade = amostra->cor.severidade;
+    const uint8_t *rgb = amostra->cor.rgb_modos[modo];
+    int n = snprintf(json, sizeof(json), "{\"modo\":\"%s\",\"severidade\":%d,\"nome\":\"%s\",\"rgb\":[%u,%u,%u],\"modos\":[",
+                     nome_modo_daltonismo(modo, severidade), severidade * 100 / DALTONISMO_SEVERIDADE_MAX,
+                     tabelas_cores_nome(amostra->cor.identificacao.candidatas[0].indice), rgb[0], rgb[1], rgb[2]);
+    for (int m = 0; m <= DALTONISMO_NUM_TIPOS && n < (int)sizeof(json); m++) {
+        const uint8_t *s = amostra->cor.rgb_modos[m];
+        const uint8_t *c = amostra->cor.rgb_daltonizado[m];
+        n += snprintf(json + n, sizeof(json) - n, "%s[\"%s\",%u,%u,%u,%u,%u,%u]", m ? "," : "",
+                      nome_modo_daltonismo(m, severidade), s[0], s[1], s[2], c[0], c[1], c[2]);
+    }
+    if (n < (int)sizeof(json)) {
+        snprintf(json + n, sizeof(json) - n, "]}");
+    }
+    return json;
+}
+
+// Monta a resposta inteira no buffer da conexão (os geradores devolvem buffers estáticos,
+// reescritos a cada chamada) e começa a enviá-la. 'extras' são linhas de cabeçalho
+// completas ("ETag: ...\r\n"); 'corpo' NULL = resposta sem corpo (204, 304).
+static void conexao_responder(conexao_http_t *c, const char *status, const char *content_type,
+                              const char *extras, const char *corpo) {
+    const char *conexao = c->manter ? "keep-alive" : "close";
+    int corpo_len = corpo ? strlen(corpo) : 0;
+    int n;
+    if (corpo) {
+        n = snprintf(c->resposta, sizeof(c->resposta),
+                     "HTTP/1.1 %s\r\nContent-Length: %d\r\nContent-Type: %s\r\n%sConnection: %s\r\n\r\n",
+                     status, corpo_len, content_type, extras, conexao);
+    } else {
+        n = snprintf(c->resposta, sizeof(c->resposta),
+                     "HTTP/1.1 %s\r\n%sConnection: %s\r\n\r\n", status, extras, conexao);
+    }
+    if (n + corpo_len >= (int)sizeof(c->resposta)) {
+        DEBUG_printf("Resposta de %d bytes nao cabe no buffer da conexao\n", n + corpo_len);
+        c->manter = false;
+        n = snprintf(c->resposta, sizeof(c->resposta),
+                     "HTTP/1.1 500 Internal Server Error\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+        corpo_len = 0;
+    }
+    // HEAD: os mesmos cabeçalhos, sem o corpo
+    if (corpo_len > 0 && c->pedido.metodo != HTTP_METODO_HEAD) {
+        memcpy(c->resposta + n, corpo, corpo_len);
+        n += corpo_len;
+    }
+    c->resposta_len = n;
+    c->flash = NULL;
+    c->flash_len = 0;
+    c->escrito = 0;
+    c->confirmado = 0;
+    conexao_enviar(c);
+}
+
+// Arquivo da página: cabeçalhos prontos da tabela e o corpo direto da flash,
+// sem cópia. O custo em RAM não depende do tamanho do arquivo. Sem "gzip" no
+// Accept-Encoding, vai a cópia sem compressão (com ETag próprio).
+static void conexao_responder_ativo(conexao_http_t *c, const ativo_web_t *ativo) {
+    if (ativo->gzip && !c->pedido.aceita_gzip) {
+        ativo = ativo->sem_gzip;
+    }
+    if (strcmp(c->pedido.if_none_match, ativo->etag) == 0) {
+        char extras[40];
+        snprintf(extras, sizeof(extras), "ETag: %s\r\n", ativo->etag);
+        conexao_responder(c, "304 Not Modified", NULL, extras, NULL);
+        return;
+    }
+    c->resposta_len = snprintf(c->resposta, sizeof(c->resposta), "HTTP/1.1 200 OK\r\n%sConnection: %s\r\n\r\n",
+                               ativo->cabecalhos, c->manter ? "keep-alive" : "close");
+    bool corpo = c->pedido.metodo != HTTP_METODO_HEAD;
+    c->flash = corpo ? ativo->dados : NULL;
+    c->flash_len = corpo ? ativo->tamanho : 0;
+    c->escrito = 0;
+    c->confirmado = 0;
+    conexao_enviar(c);
+}
+
+// "/" é a página; os demais caminhos, o próprio nome do arquivo em web/.
+static const ativo_web_t *procurar_ativo(const char *caminho, size_t len) {
+    if (len == 1) {
+        caminho = "/index.html";
+        len = strlen(caminho);
+    }
+    for (size_t i = 0; i < ATIVOS_WEB_QUANTIDADE; i++) {
+        if (strlen(ativos_web[i].caminho) == len && strncmp(caminho, ativos_web[i].caminho, len) == 0) {
+            return &ativos_web[i];
+        }
+    }
+    return NULL;
+}
+
+static void responder_json(conexao_http_t *c, const char *status, const char *corpo) {
+    conexao_responder(c, status, "application/json", "", corpo);
+}
+
+// --- Rotas ---
+// Cada rota atende o pedido já analisado em c->pedido e responde, ou entrega a
+// conexão a outro módulo (c->pcb fica NULL).
+
+// O navegador pede o ícone a cada carga da página; sem ícone, fica no cache por um dia.
+static void rota_favicon(conexao_http_t *c) {
+    conexao_responder(c, "204 No Content", NULL, "Cache-Control: max-age=86400\r\n", NULL);
+}
+
+static void rota_api_cor(conexao_http_t *c) {
+    responder_json(c, "200 OK", generate_color_json());
+}
+
+static void rota_api_historico(conexao_http_t *c) {
+    responder_json(c, "200 OK", generate_history_json());
+}
+
+// GET /api/severidade?valor=N muda a severidade (0-100%) e devolve o JSON de /api/cor
+static void rota_api_severidade(conexao_http_t *c) {
+    if (!definir_severidade_web(c->pedido.caminho, strlen(c->pedido.caminho))) {
+        responder_json(c, "400 Bad Request", "{\"erro\":\"valor deve ser de 0 a 100\"}");
+        return;
+    }
+    responder_json(c, "200 OK", generate_color_json());
+}
+
+// A conexão fica aberta e passa para eventos_sse.c
+static void rota_eventos(conexao_http_t *c) {
+    struct tcp_pcb *pcb = c->pcb;
+    conexao_entregar(c); // O SSE não lê nada do cliente
+    if (eventos_sse_assinar(pcb)) {
+        return;
+    }
+    c->pcb = pcb;
+    c->manter = false;
+    responder_json(c, "503 Service Unavailable", "{\"erro\":\"limite de assinantes\"}");
+}
+
+// Depois do handshake, a conexão passa para canal_websocket.c. Sem "Upgrade: websocket"
+// ou sem versão, 400; versão diferente de 13, 426 com a versão suportada (RFC 6455, 4.4).
+static void rota_websocket(conexao_http_t *c) {
+    if (!c->pedido.upgrade_websocket || c->pedido.websocket_versao == 0) {
+        c->manter = false;
+        responder_json(c, "400 Bad Request", "{\"erro\":\"faltam Upgrade: websocket ou Sec-WebSocket-Version\"}");
+        return;
+    }
+    if (c->pedido.websocket_versao != 13) {
+        c->manter = false;
+        conexao_responder(c, "426 Upgrade Required", "application/json", "Sec-WebSocket-Version: 13\r\n",
+                          "{\"erro\":\"versao WebSocket nao suportada\"}");
+        return;
+    }
+    // Quadros que o cliente mandou logo atrás do pedido seguem para o canal
+    if (canal_websocket_aceitar(c->pcb, c->pedido.websocket_chave, c->recebido)) {
+        conexao_entregar(c);
+        return;
+    }
+    c->manter = false;
+    responder_json(c, "400 Bad Request", "{\"erro\":\"handshake WebSocket invalido ou sem lugar\"}");
+}
+
+typedef struct {
+    const char *caminho; // Sem a consulta
+    void (*atender)(conexao_http_t *c);
+} rota_http_t;
+
+static const rota_http_t rotas[] = {
+    {"/favicon.ico", rota_favicon},
+    {"/api/cor", rota_api_cor},
+    {"/api/historico", rota_api_historico},
+    {"/api/severidade", rota_api_severidade},
+    {"/events", rota_eventos},
+    {"/ws", rota_websocket},
+};
+
+static void conexao_atender(conexao_http_t *c) {
+    const analisador_http_t *pedido = &c->pedido;
+    c->manter = pedido->manter_conexao;
+
+    if (pedido->metodo == HTTP_METODO_OUTRO) {
+        conexao_responder(c, "405 Method Not Allowed", "application/json", "Allow: GET, HEAD\r\n",
+                          "{\"erro\":\"metodo nao suportado\"}");
+        return;
+    }
+    size_t len = strcspn(pedido->caminho, "?");
+    const ativo_web_t *ativo = procurar_ativo(pedido->caminho, len);
+    if (ativo) {
+        conexao_responder_ativo(c, ativo);
+        return;
+    }
+    for (size_t i = 0; i < sizeof(rotas) / sizeof(rotas[0]); i++) {
+        if (strlen(rotas[i].caminho) == len && strncmp(pedido->caminho, rotas[i].caminho, len) == 0) {
+            rotas[i].atender(c);
+            return;
+        }
+    }
+    if (strncmp(pedido->caminho, "/api/", 5) == 0) {
+        responder_json(c, "404 Not Found", "{\"erro\":\"rota desconhecida\"}");
     } else {
+        // Qualquer outro endereço (o DNS responde por todos os nomes, e os sistemas
+        // testam o portal cativo com os seus) volta para a página.
+        conexao_responder(c, "302 Found", NULL, "Location: /\r\nContent-Length: 0\r\n", NULL);
+    }
+}
+
+static const char *status_erro(uint16_t status) {
+    switch (status) {
+        case 414: return "414 URI Too Long";
+        case 431: return "431 Request Header Fields Too Large";
+        case 501: return "501 Not Implemented";
+        default: return "400 Bad Request";
+    }
+}
+
+// Analisa o que houver em c->recebido, um pedido por vez: o próximo só depois
+// que a resposta do atual for toda confirmada.
+static void conexao_processar(conexao_http_t *c) {
+    while (c->pcb && c->recebido && c->resposta_len == 0) {
+        struct pbuf *p = c->recebido;
+        int usados;
+        analisador_http_resultado_t r = analisador_http_alimentar(&c->pedido, p->payload, p->len, &usados);
+        tcp_recved(c->pcb, usados);
+        c->recebido = pbuf_free_header(p, usados);
+
+        if (r == ANALISADOR_HTTP_COMPLETO) {
+            conexao_atender(c);
+        } else if (r == ANALISADOR_HTTP_ERRO) {
+            c->manter = false;
+            responder_json(c, status_erro(c->pedido.status), "{\"erro\":\"pedido invalido\"}");
+        }
+    }
+}
+
+static err_t tcp_server_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err) {
+    conexao_http_t *c = (conexao_http_t *)arg;
+    if (!p) {
+        DEBUG_printf("tcp_server_recv: No pbuf, closing connection.\n");
+        return conexao_fechar(c) ? ERR_ABRT : ERR_OK;
+    }
+    if (err != ERR_OK) {
         DEBUG_printf("tcp_server_recv error %d\n", err);
+        tcp_recved(tpcb, p->tot_len);
+        pbuf_free(p);
+        return ERR_OK;
     }
-    pbuf_free(p); // Liberar o pbuf
+    conexao_tocar(c);
+
+    // Os bytes só são confirmados ao lwIP (tcp_recved) quando analisados.
+    if (c->recebido) {
+        pbuf_cat(c->recebido, p);
+    } else {
+        c->recebido = p;
+    }
+    conexao_processar(c);
     return ERR_OK;
 }
 
+// Lugar para uma conexão nova: um livre ou, com o pool cheio, o da conexão
+// há mais tempo sem atividade, que é abortada.
+static conexao_http_t *conexao_reservar(void) {
+    conexao_http_t *mais_antiga = &conexoes[0];
+    for (int i = 0; i < HTTP_MAX_CONEXOES; i++) {
+        if (!conexoes[i].pcb) {
+            return &conexoes[i];
+        }
+        if (conexoes[i].ultimo_uso_us < mais_antiga->ultimo_uso_us) {
+            mais_antiga = &conexoes[i];
+        }
+    }
+    DEBUG_printf("Pool HTTP cheio: descartando a conexao menos recente\n");
+    struct tcp_pcb *pcb = mais_antiga->pcb;
+    conexao_liberar(mais_antiga);
+    tcp_arg(pcb, NULL);
+    tcp_abort(pcb);
+    return mais_antiga;
+}
 
 static err_t tcp_server_accept(void *arg, struct tcp_pcb *client_pcb, err_t err) {
-    TCP_SERVER_T *state = (TCP_SERVER_T*)arg;
     if (err != ERR_OK || client_pcb == NULL) {
         DEBUG_printf("tcp_server_accept error %d\n", err);
         return ERR_VAL;
     }
     DEBUG_printf("TCP client accepted\n");
-    state->tcp_client_pcb = client_pcb;
-    tcp_arg(client_pcb, state);
+    conexao_http_t *c = conexao_reservar();
+    c->pcb = client_pcb;
+    analisador_http_iniciar(&c->pedido);
+    c->resposta_len = 0;
+    c->flash_len = 0;
+    c->escrito = 0;
+    c->confirmado = 0;
+    conexao_tocar(c);
+    tcp_arg(client_pcb, c);
     tcp_recv(client_pcb, tcp_server_recv);
     tcp_err(client_pcb, tcp_server_error);
     tcp_sent(client_pcb, tcp_server_sent);
+    tcp_poll(client_pcb, tcp_server_poll, HTTP_INTERVALO_POLL);
     return ERR_OK;
 }
 
@@ -205,7 +667,7 @@ static bool tcp_server_open(void *arg, const char *ap_name) {
         return false;
     }
 
-    state->tcp_server_pcb = tcp_listen_with_backlog(tpcb, 5); // Permite mais conexões pendentes
+    state->tcp_server_pcb = tcp_listen_with_backlog(tpcb, HTTP_MAX_CONEXOES); // Permite mais conexões pendentes
     if (!state->tcp_server_pcb) {
         DEBUG_printf("failed to listen\n");
         return false;
@@ -219,10 +681,6 @@ static bool tcp_server_open(void *arg, const char *ap_name) {
 
 // --- Função Principal do Core 1 ---
 void core1_entry() {
-    // Inicializa o mutex para dados compartilhados (somente uma vez, idealmente no main)
-    // No entanto, é seguro inicializar aqui também se o main garantir que não há raça.
-    // Para simplificar, vamos inicializar aqui, mas o main também o fará.
-    mutex_init(&shared_data_mutex);
     // Inicialização do Wi-Fi
     if (cyw43_arch_init()) {
         printf("ERRO: Falha ao inicializar o Wi-Fi (CYW43).\n");
@@ -260,6 +718,8 @@ void core1_entry() {
     printf("Servidor web no Core 1 pronto! Conecte-se à rede '%s' e acesse http://192.168.4.1\n", AP_NAME);
 
     while (true) {
+        // Amostras novas antes de atender a rede: as respostas saem da mais recente.
+        consumir_amostras();
         // Este loop é essencial para o polling do Wi-Fi e lwIP.
         // Ele garante que o stack de rede processe pacotes.
         cyw43_arch_poll();
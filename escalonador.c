@@ -0,0 +1,140 @@
+// escalonador.c
+#include "escalonador.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "pico/stdlib.h"
+#include "pico/time.h"      // add_alarm_at
+#include "hardware/sync.h"  // __wfe, __sev
+#include "hardware/timer.h" // time_us_64
+
+typedef struct {
+    const char *nome;
+    tarefa_funcao_t funcao;
+    uint32_t periodo_us;
+    uint64_t prazo_us; // Próximo início previsto
+    // Estatísticas da janela atual (zeradas a cada relatório)
+    uint32_t execucoes;
+    uint32_t estouros;
+    uint32_t atraso_max_us;
+    uint64_t atraso_soma_us;
+    uint32_t duracao_max_us;
+} tarefa_t;
+
+static tarefa_t tarefas[ESCALONADOR_MAX_TAREFAS];
+static int num_tarefas = 0;
+
+// Alarme do próximo prazo: a IRQ só marca o disparo e acorda o núcleo.
+static volatile bool alarme_disparou = false;
+static alarm_id_t alarme = 0;
+static uint64_t alarme_prazo_us = 0;
+
+static int64_t alarme_callback(alarm_id_t id, void *dados) {
+    (void)id;
+    (void)dados;
+    alarme_disparou = true;
+    __sev();
+    return 0; // Não repete: o próximo alarme é armado pelo laço
+}
+
+int escalonador_adicionar(const char *nome, tarefa_funcao_t funcao, uint32_t periodo_us) {
+    if (num_tarefas == ESCALONADOR_MAX_TAREFAS) {
+        return -1;
+    }
+    tarefas[num_tarefas] = (tarefa_t){
+        .nome = nome,
+        .funcao = funcao,
+        .periodo_us = periodo_us,
+        .prazo_us = time_us_64(),
+    };
+    return num_tarefas++;
+}
+
+void escalonador_definir_periodo(int tarefa, uint32_t periodo_us) {
+    tarefas[tarefa].periodo_us = periodo_us;
+}
+
+// Roda a tarefa e agenda o próximo início, mantendo a fase: um estouro pula os
+// períodos perdidos em vez de tentar recuperá-los em rajada.
+static void rodar(tarefa_t *t, uint64_t inicio) {
+    uint32_t atraso = (uint32_t)(inicio - t->prazo_us);
+    t->funcao();
+    uint64_t fim = time_us_64();
+    uint32_t duracao = (uint32_t)(fim - inicio);
+
+    t->execucoes++;
+    t->atraso_soma_us += atraso;
+    if (atraso > t->atraso_max_us) {
+        t->atraso_max_us = atraso;
+    }
+    if (duracao > t->duracao_max_us) {
+        t->duracao_max_us = duracao;
+    }
+
+    t->prazo_us += t->periodo_us;
+    if (t->prazo_us <= fim) {
+        t->estouros++;
+        t->prazo_us += (fim - t->prazo_us) / t->periodo_us * t->periodo_us + t->periodo_us;
+    }
+}
+
+// Dorme até 'prazo' ou até qualquer interrupção (ex.: botão), o que vier primeiro.
+static void dormir_ate(uint64_t prazo) {
+    if (alarme != 0 && alarme_prazo_us != prazo) {
+        cancel_alarm(alarme);
+        alarme = 0;
+    }
+    if (alarme == 0) {
+        alarme_disparou = false;
+        alarme = add_alarm_at(from_us_since_boot(prazo), alarme_callback, NULL, true);
+        alarme_prazo_us = prazo;
+        if (alarme <= 0) {
+            // Sem alarme livre (ou o prazo já passou): espera ocupada, por garantia.
+            alarme = 0;
+            busy_wait_until(from_us_since_boot(prazo));
+            return;
+        }
+    }
+    if (!alarme_disparou && time_us_64() < prazo) {
+        __wfe();
+    }
+    if (alarme_disparou) {
+        alarme = 0;
+    }
+}
+
+void escalonador_executar(void) {
+    while (true) {
+        uint64_t agora = time_us_64();
+        tarefa_t *proxima = NULL;
+        for (int i = 0; i < num_tarefas; i++) {
+            if (proxima == NULL || tarefas[i].prazo_us < proxima->prazo_us) {
+                proxima = &tarefas[i];
+            }
+        }
+        if (proxima == NULL) {
+            __wfe();
+        } else if (proxima->prazo_us <= agora) {
+            rodar(proxima, agora);
+        } else {
+            dormir_ate(proxima->prazo_us);
+        }
+    }
+}
+
+void escalonador_relatar(void) {
+    printf("Tarefa          Exec  Estouros  Atraso med/max (us)  Duracao max (us)\n");
+    for (int i = 0; i < num_tarefas; i++) {
+        tarefa_t *t = &tarefas[i];
+        uint32_t atraso_medio = t->execucoes ? (uint32_t)(t->atraso_soma_us / t->execucoes) : 0;
+        printf("%-14s %5lu  %8lu  %8lu / %-8lu  %8lu\n", t->nome, (unsigned long)t->execucoes,
+               (unsigned long)t->estouros, (unsigned long)atraso_medio, (unsigned long)t->atraso_max_us,
+               (unsigned long)t->duracao_max_us);
+        t->execucoes = 0;
+        t->estouros = 0;
+        t->atraso_max_us = 0;
+        t->atraso_soma_us = 0;
+        t->duracao_max_us = 0;
+    }
+}
@@ -0,0 +1,43 @@
+// escalonador.h
+#ifndef ESCALONADOR_H
+#define ESCALONADOR_H
+
+#include <stdint.h>
+
+// Escalonador cooperativo do Core 0: cada tarefa tem o seu período e roda inteira,
+// sem preempção. Entre uma tarefa e outra, o núcleo dorme (__wfe) até o próximo
+// prazo, marcado num alarme de hardware. Não usa alocação dinâmica.
+
+#define ESCALONADOR_MAX_TAREFAS 8
+
+typedef void (*tarefa_funcao_t)(void);
+
+/**
+ * @brief Registra uma tarefa periódica; a primeira execução é imediata.
+ * @param nome Usado no relatório; precisa continuar válido (literal).
+ * @param periodo_us Intervalo entre os inícios, em microssegundos.
+ * @return Identificador da tarefa, ou -1 se não houver mais lugar.
+ */
+int escalonador_adicionar(const char *nome, tarefa_funcao_t funcao, uint32_t periodo_us);
+
+/**
+ * @brief Troca o período de uma tarefa; vale a partir do próximo início.
+ */
+void escalonador_definir_periodo(int tarefa, uint32_t periodo_us);
+
+/**
+ * @brief Roda as tarefas para sempre. Entre as que já venceram, a de prazo mais
+ * antigo vai primeiro.
+ */
+void escalonador_executar(void);
+
+/**
+ * @brief Imprime, por tarefa, execuções, estouros, atraso no início (jitter) e
+ * duração, e começa uma nova janela de medição.
+ *
+ * Estouro: a tarefa terminou depois do seu próximo prazo, e os períodos perdidos
+ * foram pulados.
+ */
+void escalonador_relatar(void);
+
+#endif // ESCALONADOR_H
@@ -0,0 +1,201 @@
+// eventos_sse.c
+#include "eventos_sse.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// Comentário SSE enviado a cada ~15 s sem eventos: mantém a conexão viva e
+// revela clientes que sumiram. Em unidades do tcp_poll (500 ms).
+#define EVENTOS_SSE_INTERVALO_PING 30
+
+static const char cabecalho_sse[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: text/event-stream\r\n"
+    "Cache-Control: no-cache\r\n"
+    "Connection: keep-alive\r\n"
+    "\r\n";
+static const char ping_sse[] = ": \n\n";
+
+// Um trecho já escrito no pcb e ainda não confirmado. 'evento' é NULL para o que
+// foi copiado (cabeçalho, ping): só conta os bytes.
+typedef struct {
+    struct pbuf *evento;
+    uint16_t falta;
+} pendente_t;
+
+typedef struct {
+    struct tcp_pcb *pcb; // NULL = lugar livre
+    pendente_t pendentes[EVENTOS_SSE_PENDENTES];
+    uint8_t inicio;
+    uint8_t quantidade;
+} assinante_t;
+
+static assinante_t assinantes[EVENTOS_SSE_MAX_ASSINANTES];
+// O último evento, com uma referência própria: é o primeiro de cada assinante novo.
+static struct pbuf *ultimo_evento = NULL;
+
+// Escreve 'len' bytes e registra o trecho; com 'evento', sem cópia e com uma referência.
+static bool enfileirar(assinante_t *a, struct pbuf *evento, const void *dados, uint16_t len) {
+    if (a->quantidade == EVENTOS_SSE_PENDENTES || tcp_sndbuf(a->pcb) < len) {
+        return false;
+    }
+    if (tcp_write(a->pcb, dados, len, evento ? 0 : TCP_WRITE_FLAG_COPY) != ERR_OK) {
+        return false;
+    }
+    if (evento) {
+        pbuf_ref(evento);
+    }
+    pendente_t *p = &a->pendentes[(a->inicio + a->quantidade) % EVENTOS_SSE_PENDENTES];
+    p->evento = evento;
+    p->falta = len;
+    a->quantidade++;
+    return true;
+}
+
+// Solta as referências do assinante e libera o lugar; o pcb já foi fechado ou abortado.
+static void liberar(assinante_t *a) {
+    for (; a->quantidade > 0; a->quantidade--) {
+        pendente_t *p = &a->pendentes[a->inicio];
+        if (p->evento) {
+            pbuf_free(p->evento);
+        }
+        a->inicio = (a->inicio + 1) % EVENTOS_SSE_PENDENTES;
+    }
+    a->inicio = 0;
+    a->pcb = NULL;
+}
+
+// Devolve true se o pcb foi abortado (o callback do lwIP deve devolver ERR_ABRT).
+static bool fechar(assinante_t *a) {
+    struct tcp_pcb *pcb = a->pcb;
+    tcp_arg(pcb, NULL);
+    tcp_sent(pcb, NULL);
+    tcp_recv(pcb, NULL);
+    tcp_err(pcb, NULL);
+    tcp_poll(pcb, NULL, 0);
+    // Os trechos sem cópia ainda na fila do pcb continuam apontando para os pbufs:
+    // com o abort, o lwIP os descarta antes de as referências serem soltas.
+    bool abortar = a->quantidade > 0 || tcp_close(pcb) != ERR_OK;
+    if (abortar) {
+        tcp_abort(pcb);
+    }
+    liberar(a);
+    return abortar;
+}
+
+// ACK do cliente: solta os eventos confirmados por inteiro.
+static err_t assinante_sent(void *arg, struct tcp_pcb *pcb, u16_t len) {
+    assinante_t *a = (assinante_t *)arg;
+    while (len > 0 && a->quantidade > 0) {
+        pendente_t *p = &a->pendentes[a->inicio];
+        uint16_t confirmado = len < p->falta ? len : p->falta;
+        p->falta -= confirmado;
+        len -= confirmado;
+        if (p->falta == 0) {
+            if (p->evento) {
+                pbuf_free(p->evento);
+            }
+            a->inicio = (a->inicio + 1) % EVENTOS_SSE_PENDENTES;
+            a->quantidade--;
+        }
+    }
+    return ERR_OK;
+}
+
+static err_t assinante_recv(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err) {
+    assinante_t *a = (assinante_t *)arg;
+    if (!p) { // O cliente fechou
+        return fechar(a) ? ERR_ABRT : ERR_OK;
+    }
+    // Nada a fazer com o que o cliente mandar depois do pedido
+    tcp_recved(pcb, p->tot_len);
+    pbuf_free(p);
+    return ERR_OK;
+}
+
+static void assinante_err(void *arg, err_t err) {
+    // O lwIP já liberou o pcb (e os trechos pendentes nele)
+    assinante_t *a = (assinante_t *)arg;
+    if (a) {
+        liberar(a);
+    }
+}
+
+static err_t assinante_poll(void *arg, struct tcp_pcb *pcb) {
+    assinante_t *a = (assinante_t *)arg;
+    if (enfileirar(a, NULL, ping_sse, sizeof(ping_sse) - 1)) {
+        tcp_output(pcb);
+    }
+    return ERR_OK;
+}
+
+bool eventos_sse_assinar(struct tcp_pcb *pcb) {
+    assinante_t *a = NULL;
+    for (int i = 0; i < EVENTOS_SSE_MAX_ASSINANTES && !a; i++) {
+        if (!assinantes[i].pcb) {
+            a = &assinantes[i];
+        }
+    }
+    if (!a) {
+        return false;
+    }
+    a->pcb = pcb;
+    if (!enfileirar(a, NULL, cabecalho_sse, sizeof(cabecalho_sse) - 1)) {
+        a->pcb = NULL;
+        return false;
+    }
+    tcp_arg(pcb, a);
+    tcp_sent(pcb, assinante_sent);
+    tcp_recv(pcb, assinante_recv);
+    tcp_err(pcb, assinante_err);
+    tcp_poll(pcb, assinante_poll, EVENTOS_SSE_INTERVALO_PING);
+    tcp_nagle_disable(pcb); // Eventos pequenos: sem esperar juntar mais dados
+
+    if (ultimo_evento) {
+        enfileirar(a, ultimo_evento, ultimo_evento->payload, ultimo_evento->len);
+    }
+    tcp_output(pcb);
+    return true;
+}
+
+void eventos_sse_publicar(uint32_t id, const char *dados) {
+    char id_texto[16];
+    int n_id = snprintf(id_texto, sizeof(id_texto), "%lu", (unsigned long)id);
+    size_t n_dados = strlen(dados);
+    // "id: " + id + "\ndata: " + dados + "\n\n"
+    size_t len = 4 + n_id + 7 + n_dados + 2;
+    if (len > 0xFFFF) {
+        return;
+    }
+    struct pbuf *evento = pbuf_alloc(PBUF_RAW, (u16_t)len, PBUF_RAM);
+    if (!evento) {
+        return;
+    }
+    char *texto = (char *)evento->payload;
+    memcpy(texto, "id: ", 4);
+    memcpy(texto + 4, id_texto, n_id);
+    memcpy(texto + 4 + n_id, "\ndata: ", 7);
+    memcpy(texto + 11 + n_id, dados, n_dados);
+    memcpy(texto + 11 + n_id + n_dados, "\n\n", 2);
+
+    for (int i = 0; i < EVENTOS_SSE_MAX_ASSINANTES; i++) {
+        assinante_t *a = &assinantes[i];
+        if (a->pcb && enfileirar(a, evento, evento->payload, evento->len)) {
+            tcp_output(a->pcb);
+        }
+    }
+
+    // A referência da alocação passa a ser a do último evento
+    if (ultimo_evento) {
+        pbuf_free(ultimo_evento);
+    }
+    ultimo_evento = evento;
+}
+
+int eventos_sse_assinantes(void) {
+    int n = 0;
+    for (int i = 0; i < EVENTOS_SSE_MAX_ASSINANTES; i++) {
+        n += assinantes[i].pcb != NULL;
+    }
+    return n;
+}
@@ -0,0 +1,39 @@
+// eventos_sse.h
+#ifndef EVENTOS_SSE_H
+#define EVENTOS_SSE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "lwip/tcp.h"
+
+// Server-Sent Events (GET /events): as conexões ficam abertas e cada atualização
+// é empurrada para todas. O evento é codificado uma vez num pbuf, e cada assinante
+// o envia sem cópia (tcp_write sem TCP_WRITE_FLAG_COPY), com uma referência a mais
+// no pbuf até o seu ACK. Roda só no Core 1, dentro dos callbacks do lwIP.
+
+#define EVENTOS_SSE_MAX_ASSINANTES 4
+// Eventos enviados e ainda não confirmados por assinante; com a fila cheia,
+// o assinante lento pula eventos (cada um traz o estado inteiro).
+#define EVENTOS_SSE_PENDENTES 4
+
+/**
+ * @brief Transforma a conexão numa assinatura: envia o cabeçalho SSE e o último evento.
+ *
+ * Assume os callbacks do pcb; quem chamou não deve mais usá-lo.
+ * @return false se não houver lugar (a conexão continua com quem chamou).
+ */
+bool eventos_sse_assinar(struct tcp_pcb *pcb);
+
+/**
+ * @brief Codifica "id: <id>\ndata: <dados>\n\n" uma vez e envia a todos os assinantes.
+ * @param dados Uma linha, sem '\n' (ex.: JSON compacto).
+ */
+void eventos_sse_publicar(uint32_t id, const char *dados);
+
+/**
+ * @brief Assinantes conectados agora.
+ */
+int eventos_sse_assinantes(void);
+
+#endif // EVENTOS_SSE_H
@@ -0,0 +1,149 @@
+// filtro_amostras.c
+#include "filtro_amostras.h"
+#include <stdbool.h>
+
+// Distância máxima até a mediana, em múltiplos do desvio absoluto mediano (MAD),
+// para uma amostra entrar na média do modo FILTRO_REJEITA_OUTLIERS.
+#define LIMIAR_OUTLIER_MAD 3
+
+void filtro_amostras_init(filtro_amostras_t *filtro, filtro_modo_t modo, uint8_t janela, uint16_t alfa_q8)
+{
+    filtro->modo = modo;
+    filtro->janela = (janela < 1) ? 1 : (janela > FILTRO_JANELA_MAX ? FILTRO_JANELA_MAX : janela);
+    filtro->alfa_q8 = (alfa_q8 < 1) ? 1 : (alfa_q8 > 256 ? 256 : alfa_q8);
+    filtro_amostras_reiniciar(filtro);
+}
+
+void filtro_amostras_reiniciar(filtro_amostras_t *filtro)
+{
+    filtro->posicao = 0;
+    filtro->quantidade = 0;
+}
+
+// Ordena 'n' valores (n <= FILTRO_JANELA_MAX: inserção é o mais barato aqui).
+static void ordenar(uint16_t *valores, int n)
+{
+    for (int i = 1; i < n; i++)
+    {
+        uint16_t v = valores[i];
+        int j = i - 1;
+        while (j >= 0 && valores[j] > v)
+        {
+            valores[j + 1] = valores[j];
+            j--;
+        }
+        valores[j + 1] = v;
+    }
+}
+
+static uint16_t mediana_ordenada(const uint16_t *ordenados, int n)
+{
+    if (n & 1)
+    {
+        return ordenados[n / 2];
+    }
+    return (uint16_t)(((uint32_t)ordenados[n / 2 - 1] + ordenados[n / 2] + 1) / 2);
+}
+
+// Copia as 'n' amostras mais recentes do canal.
+static void copiar_janela(const filtro_amostras_t *filtro, int canal, int n, uint16_t *destino)
+{
+    int indice = filtro->posicao;
+    for (int i = 0; i < n; i++)
+    {
+        indice = (indice == 0) ? FILTRO_JANELA_MAX - 1 : indice - 1;
+        destino[i] = filtro->historico[canal][indice];
+    }
+}
+
+static uint16_t filtrar_mediana(const filtro_amostras_t *filtro, int canal, int n)
+{
+    uint16_t janela[FILTRO_JANELA_MAX];
+    copiar_janela(filtro, canal, n, janela);
+    ordenar(janela, n);
+    return mediana_ordenada(janela, n);
+}
+
+static uint16_t filtrar_rejeitando_outliers(const filtro_amostras_t *filtro, int canal, int n)
+{
+    uint16_t janela[FILTRO_JANELA_MAX];
+    uint16_t desvios[FILTRO_JANELA_MAX];
+    copiar_janela(filtro, canal, n, janela);
+
+    uint16_t ordenados[FILTRO_JANELA_MAX];
+    for (int i = 0; i < n; i++)
+    {
+        ordenados[i] = janela[i];
+    }
+    ordenar(ordenados, n);
+    uint16_t mediana = mediana_ordenada(ordenados, n);
+
+    for (int i = 0; i < n; i++)
+    {
+        desvios[i] = (janela[i] > mediana) ? janela[i] - mediana : mediana - janela[i];
+    }
+    ordenar(desvios, n);
+    // +1 para que uma janela sem ruído (MAD = 0) ainda aceite variações de 1 contagem.
+    uint32_t limiar = (uint32_t)mediana_ordenada(desvios, n) * LIMIAR_OUTLIER_MAD + 1;
+
+    uint32_t soma = 0;
+    int aceitas = 0;
+    for (int i = 0; i < n; i++)
+    {
+        uint32_t desvio = (janela[i] > mediana) ? janela[i] - mediana : mediana - janela[i];
+        if (desvio <= limiar)
+        {
+            soma += janela[i];
+            aceitas++;
+        }
+    }
+    // A mediana sempre está dentro do limiar, então 'aceitas' nunca é zero
+    return (uint16_t)((soma + aceitas / 2) / aceitas);
+}
+
+void filtro_amostras_processar(filtro_amostras_t *filtro, const uint16_t entrada[FILTRO_CANAIS],
+                               uint16_t saida[FILTRO_CANAIS])
+{
+    bool primeira = (filtro->quantidade == 0);
+
+    // O histórico é sempre atualizado, para que a troca de modo não perca amostras.
+    for (int c = 0; c < FILTRO_CANAIS; c++)
+    {
+        filtro->historico[c][filtro->posicao] = entrada[c];
+    }
+    filtro->posicao = (filtro->posicao + 1) % FILTRO_JANELA_MAX;
+    if (filtro->quantidade < FILTRO_JANELA_MAX)
+    {
+        filtro->quantidade++;
+    }
+
+    int n = (filtro->quantidade < filtro->janela) ? filtro->quantidade : filtro->janela;
+
+    for (int c = 0; c < FILTRO_CANAIS; c++)
+    {
+        // A EMA é mantida em todos os modos pelo mesmo motivo.
+        int32_t amostra_q8 = (int32_t)entrada[c] << 8;
+        if (primeira)
+        {
+            filtro->ema_q8[c] = amostra_q8;
+        }
+        else
+        {
+            filtro->ema_q8[c] += (int32_t)(((int64_t)(amostra_q8 - filtro->ema_q8[c]) * filtro->alfa_q8) >> 8);
+        }
+
+        switch (filtro->modo)
+        {
+        case FILTRO_EMA:
+            saida[c] = (uint16_t)((filtro->ema_q8[c] + 128) >> 8);
+            break;
+        case FILTRO_MEDIANA:
+            saida[c] = filtrar_mediana(filtro, c, n);
+            break;
+        case FILTRO_REJEITA_OUTLIERS:
+        default:
+            saida[c] = filtrar_rejeitando_outliers(filtro, c, n);
+            break;
+        }
+    }
+}
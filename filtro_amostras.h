@@ -0,0 +1,51 @@
+// filtro_amostras.h
+#ifndef FILTRO_AMOSTRAS_H
+#define FILTRO_AMOSTRAS_H
+
+#include <stdint.h>
+
+#define FILTRO_CANAIS 4      // clear, vermelho, verde, azul
+#define FILTRO_JANELA_MAX 9  // Tamanho máximo do histórico de cada canal
+
+// Modos de suavização
+typedef enum {
+    FILTRO_EMA,              // Média móvel exponencial
+    FILTRO_MEDIANA,          // Mediana móvel da janela
+    FILTRO_REJEITA_OUTLIERS  // Média da janela descartando amostras longe da mediana
+} filtro_modo_t;
+
+// Estado do filtro: um buffer circular por canal. Não usa alocação dinâmica.
+typedef struct {
+    filtro_modo_t modo;
+    uint8_t janela;    // Amostras consideradas pela mediana/rejeição (1..FILTRO_JANELA_MAX)
+    uint16_t alfa_q8;  // Peso da amostra nova na EMA (Q8, 1..256: 256 = só a amostra nova)
+    uint8_t posicao;   // Onde a próxima amostra será gravada
+    uint8_t quantidade; // Amostras válidas no histórico
+    uint16_t historico[FILTRO_CANAIS][FILTRO_JANELA_MAX];
+    int32_t ema_q8[FILTRO_CANAIS];
+} filtro_amostras_t;
+
+/**
+ * @brief Configura o filtro e descarta o histórico.
+ * @param janela Número de amostras da janela (limitado a FILTRO_JANELA_MAX).
+ * @param alfa_q8 Peso da amostra nova na EMA, em Q8, de 1 a 256 (ex.: 64 = 0.25; 256 = sem
+ *                suavização). Fora da faixa, é limitado a ela.
+ */
+void filtro_amostras_init(filtro_amostras_t *filtro, filtro_modo_t modo, uint8_t janela, uint16_t alfa_q8);
+
+/**
+ * @brief Descarta o histórico (ex.: quando a exposição do sensor muda).
+ */
+void filtro_amostras_reiniciar(filtro_amostras_t *filtro);
+
+/**
+ * @brief Insere uma amostra e devolve o valor suavizado de cada canal.
+ *
+ * Uma saída por amostra: a taxa de saída é igual à taxa do sensor.
+ * @param entrada Amostra nova (FILTRO_CANAIS valores).
+ * @param saida Valores suavizados (FILTRO_CANAIS valores).
+ */
+void filtro_amostras_processar(filtro_amostras_t *filtro, const uint16_t entrada[FILTRO_CANAIS],
+                               uint16_t saida[FILTRO_CANAIS]);
+
+#endif // FILTRO_AMOSTRAS_H
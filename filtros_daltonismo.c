@@ -1,117 +1,332 @@
-#include <math.h>   // Para roundf e fminf/fmaxf
 #include <stdint.h> // Para uint8_t
-#include <stdio.h> // Para printf de depuração, se necessário
-
-// Se estiver em um arquivo separado, inclua o cabeçalho
-// #include "filtros_daltonismo.h"
-
-// --- Matrizes de Transformação ---
-// RGB linear para LMS (Smith & Pokorny, 1975)
-static const float sRGB_to_LMS_matrix[3][3] = {
-    {0.4002f, 0.7076f, -0.0808f},
-    {-0.2263f, 1.1653f, 0.0457f},
-    {0.0000f, 0.0000f, 0.9182f}
-};
-
-// LMS para RGB linear (Inversa de Smith & Pokorny, 1975)
-static const float LMS_to_sRGB_matrix[3][3] = {
-    {1.8601f, -1.1396f, 0.2782f},
-    {0.3612f, 0.6388f, 0.0000f},
-    {-0.0000f, 0.0000f, 1.0890f}
-};
-
-// Matrizes de projeção para daltonismo (Brettel, Viénot & Mollon, 1999)
-static const float protanopia_matrix[3][3] = {
-    {0.0000f, 2.0234f, -2.5258f},
-    {0.0000f, 1.0000f,  0.0000f},
-    {0.0000f, 0.0000f,  1.0000f}
-};
-
-static const float deuteranopia_matrix[3][3] = {
-    {1.0000f, 0.0000f, 0.0000f},
-    {0.4942f, 0.0000f, 0.4854f},
-    {0.0000f, 0.0000f, 1.0000f}
-};
-
-static const float tritanopia_matrix[3][3] = {
-    {1.0000f,  0.0000f, 0.0000f},
-    {0.0000f,  1.0000f, 0.0000f},
-    {-0.0393f, 0.2319f, 0.0000f}
-};
-
-/**
- * @brief Multiplica uma matriz 3x3 por um vetor 3x1.
- * @param matrix A matriz 3x3.
- * @param vector O vetor 3x1 de entrada.
- * @param result O vetor 3x1 de saída (resultado da multiplicação).
- */
-static void multiply_matrix_vector(const float matrix[3][3], const float vector[3], float result[3]) {
+#include <string.h> // Para memmove
+
+#include "filtros_daltonismo.h"
+#include "transferencia_srgb.h" // sRGB <-> linear por tabela
+
+// As matrizes de Machado, Oliveira & Fernandes (uma por severidade) e, para tipos
+// sem elas, as de Smith & Pokorny (RGB <-> LMS) e as projeções de Brettel, Viénot
+// & Mollon ficam em tools/gerar_tabelas_filtros.py, que gera um único núcleo por
+// tipo e severidade (daltonismo_nucleo_q12). A daltonização (cor
+// corrigida, I + E (I - S)) sai do mesmo jeito: daltonismo_correcao_q12.
+
+// Converte o resultado em linear Q12 para sRGB, com clamping em [0, 255]
+static inline void gravar_srgb(const int32_t linear[3], uint8_t saida[3]) {
+    saida[0] = linear_q12_para_srgb(linear[0]);
+    saida[1] = linear_q12_para_srgb(linear[1]);
+    saida[2] = linear_q12_para_srgb(linear[2]);
+}
+
+// Núcleo 3x3: RGB linear -> RGB linear simulado (ou corrigido), numa só multiplicação.
+// É o motor matriz; no motor LUT, as severidades parciais.
+static void aplicar_nucleo(const int16_t (*nucleo)[3], const int32_t linear[3], int32_t saida[3]) {
+    // Q12 x Q12 = Q24; |coeficiente| < 8 e linear <= 4096 cabem em 32 bits.
     for (int i = 0; i < 3; i++) {
-        result[i] = 0.0f;
-        for (int j = 0; j < 3; j++) {
-            result[i] += matrix[i][j] * vector[j];
-        }
+        int32_t acc = nucleo[i][0] * linear[0] + nucleo[i][1] * linear[1] + nucleo[i][2] * linear[2];
+        saida[i] = (acc + (1 << (TRANSFERENCIA_LINEAR_BITS - 1))) >> TRANSFERENCIA_LINEAR_BITS;
+    }
+}
+
+#if TABELAS_FILTROS_LUT
+
+// Motor LUT: a grade (DALTONISMO_LUT_LADO pontos por eixo, indexada por sRGB) guarda o
+// linear simulado em Q12. Interpolação tetraédrica: ordenados os pesos de cada eixo,
+// a cor fica num dos 6 tetraedros do cubo e só 4 vértices entram na conta.
+// A grade é a do dicromata; severidade parcial usa o núcleo da severidade, que não
+// é uma mistura linear do dicromata nas matrizes de Machado et al.
+
+// Tetraedro de uma cor: não depende do tipo, então vale para todas as grades.
+typedef struct {
+    uint32_t vertice[4]; // Pontos da grade
+    int32_t peso[4];     // Em Q8, somam 256
+} tetraedro_t;
+
+static void localizar_tetraedro(uint8_t r, uint8_t g, uint8_t b, tetraedro_t *t) {
+    enum { PASSO_R = DALTONISMO_LUT_LADO * DALTONISMO_LUT_LADO, PASSO_G = DALTONISMO_LUT_LADO, PASSO_B = 1 };
+
+    uint32_t fr = daltonismo_lut_peso[r], fg = daltonismo_lut_peso[g], fb = daltonismo_lut_peso[b];
+    uint32_t base = daltonismo_lut_celula[r] * PASSO_R + daltonismo_lut_celula[g] * PASSO_G
+                    + daltonismo_lut_celula[b] * PASSO_B;
+
+    // Eixos em ordem decrescente de peso (empates na ordem R, G, B, como no gerador)
+    uint32_t f1, f2, f3, v1, v2;
+    if (fr >= fg) {
+        if (fg >= fb)      { f1 = fr; f2 = fg; f3 = fb; v1 = base + PASSO_R; v2 = v1 + PASSO_G; }
+        else if (fr >= fb) { f1 = fr; f2 = fb; f3 = fg; v1 = base + PASSO_R; v2 = v1 + PASSO_B; }
+        else               { f1 = fb; f2 = fr; f3 = fg; v1 = base + PASSO_B; v2 = v1 + PASSO_R; }
+    } else {
+        if (fr >= fb)      { f1 = fg; f2 = fr; f3 = fb; v1 = base + PASSO_G; v2 = v1 + PASSO_R; }
+        else if (fg >= fb) { f1 = fg; f2 = fb; f3 = fr; v1 = base + PASSO_G; v2 = v1 + PASSO_B; }
+        else               { f1 = fb; f2 = fg; f3 = fr; v1 = base + PASSO_B; v2 = v1 + PASSO_G; }
+    }
+
+    t->vertice[0] = base;
+    t->vertice[1] = v1;
+    t->vertice[2] = v2;
+    t->vertice[3] = base + PASSO_R + PASSO_G + PASSO_B;
+    t->peso[0] = 256 - (int32_t)f1;
+    t->peso[1] = (int32_t)(f1 - f2);
+    t->peso[2] = (int32_t)(f2 - f3);
+    t->peso[3] = (int32_t)f3;
+}
+
+// Linear simulado (Q12) de um tipo, a partir do tetraedro e do linear da entrada.
+static void simular_lut(tipo_daltonismo_t tipo, int severidade, const tetraedro_t *t,
+                        const int32_t linear[3], int32_t saida[3]) {
+    if (severidade < DALTONISMO_SEVERIDADE_MAX) {
+        aplicar_nucleo(daltonismo_nucleo_q12[tipo][severidade], linear, saida);
+        return;
+    }
+
+    const int16_t (*lut)[3] = daltonismo_lut[tipo];
+
+    // |ponto| < 2^15 e pesos em Q8: a soma cabe em 32 bits.
+    for (int i = 0; i < 3; i++) {
+        int32_t acc = lut[t->vertice[0]][i] * t->peso[0] + lut[t->vertice[1]][i] * t->peso[1]
+                      + lut[t->vertice[2]][i] * t->peso[2] + lut[t->vertice[3]][i] * t->peso[3];
+        saida[i] = (acc + 128) >> 8;
+    }
+}
+
+// Daltonização a partir da simulação vinda da LUT: linear + E (linear - simulado).
+static void daltonizar_lut(tipo_daltonismo_t tipo, const int32_t linear[3], const int32_t simulado[3],
+                           int32_t saida[3]) {
+    const int16_t (*e)[3] = daltonismo_redistribuicao_q12[tipo];
+    const int32_t erro[3] = {linear[0] - simulado[0], linear[1] - simulado[1], linear[2] - simulado[2]};
+    for (int i = 0; i < 3; i++) {
+        int32_t acc = e[i][0] * erro[0] + e[i][1] * erro[1] + e[i][2] * erro[2];
+        saida[i] = linear[i] + ((acc + (1 << (TRANSFERENCIA_LINEAR_BITS - 1))) >> TRANSFERENCIA_LINEAR_BITS);
+    }
+}
+
+#endif // TABELAS_FILTROS_LUT
+
+// O que não depende do tipo, calculado uma vez por cor.
+typedef struct {
+    int32_t linear[3]; // RGB linear em Q12
+#if TABELAS_FILTROS_LUT
+    tetraedro_t tetraedro;
+#endif
+} amostra_t;
+
+static void preparar_amostra(uint8_t r, uint8_t g, uint8_t b, amostra_t *amostra) {
+    // Converter RGB (0-255) para RGB linear em Q12, pela tabela
+    amostra->linear[0] = srgb_para_linear_q12(r);
+    amostra->linear[1] = srgb_para_linear_q12(g);
+    amostra->linear[2] = srgb_para_linear_q12(b);
+#if TABELAS_FILTROS_LUT
+    localizar_tetraedro(r, g, b, &amostra->tetraedro);
+#endif
+}
+
+// Simulação de um tipo, em linear Q12.
+static void simular(tipo_daltonismo_t tipo, int severidade, const amostra_t *amostra, int32_t simulado[3]) {
+#if TABELAS_FILTROS_LUT
+    simular_lut(tipo, severidade, &amostra->tetraedro, amostra->linear, simulado);
+#else
+    aplicar_nucleo(daltonismo_nucleo_q12[tipo][severidade], amostra->linear, simulado);
+#endif
+}
+
+// Daltonização de um tipo, em linear Q12. O motor LUT parte da simulação já feita;
+// o motor matriz tem o núcleo composto e não precisa dela.
+static void daltonizar(tipo_daltonismo_t tipo, int severidade, const amostra_t *amostra,
+                       const int32_t simulado[3], int32_t daltonizado[3]) {
+#if TABELAS_FILTROS_LUT
+    (void)severidade; // Já está na simulação
+    daltonizar_lut(tipo, amostra->linear, simulado, daltonizado);
+#else
+    (void)simulado;
+    aplicar_nucleo(daltonismo_correcao_q12[tipo][severidade], amostra->linear, daltonizado);
+#endif
+}
+
+void aplicar_filtro_daltonismo(tipo_daltonismo_t tipo, int severidade, uint8_t *r, uint8_t *g, uint8_t *b) {
+    if ((unsigned)tipo >= DALTONISMO_NUM_TIPOS || (unsigned)severidade > DALTONISMO_SEVERIDADE_MAX) {
+        return; // Tipo ou severidade desconhecidos: a cor fica como está
     }
+
+    amostra_t amostra;
+    int32_t simulado[3];
+    preparar_amostra(*r, *g, *b, &amostra);
+    simular(tipo, severidade, &amostra, simulado);
+
+    uint8_t saida[3];
+    gravar_srgb(simulado, saida);
+    *r = saida[0];
+    *g = saida[1];
+    *b = saida[2];
 }
 
-/**
- * @brief Aplica um filtro de daltonismo genérico (Protanopia, Deuteranopia, Tritanopia)
- * nos valores RGB.
- * @param r Ponteiro para o componente Vermelho (0-255).
- * @param g Ponteiro para o componente Verde (0-255).
- * @param b Ponteiro para o componente Azul (0-255).
- * @param daltonism_matrix A matriz de projeção específica para o tipo de daltonismo.
- */
-static void aplicar_filtro_generico(uint8_t *r, uint8_t *g, uint8_t *b, const float daltonism_matrix[3][3]) {
-    // 1. Converter RGB (0-255) para RGB linear (0.0-1.0)
-    float r_float = (float)*r / 255.0f;
-    float g_float = (float)*g / 255.0f;
-    float b_float = (float)*b / 255.0f;
+void aplicar_daltonizacao(tipo_daltonismo_t tipo, int severidade, uint8_t *r, uint8_t *g, uint8_t *b) {
+    if ((unsigned)tipo >= DALTONISMO_NUM_TIPOS || (unsigned)severidade > DALTONISMO_SEVERIDADE_MAX) {
+        return;
+    }
 
-    r_float = (r_float <= 0.04045f) ? (r_float / 12.92f) : powf((r_float + 0.055f) / 1.055f, 2.4f);
-    g_float = (g_float <= 0.04045f) ? (g_float / 12.92f) : powf((g_float + 0.055f) / 1.055f, 2.4f);
-    b_float = (b_float <= 0.04045f) ? (b_float / 12.92f) : powf((b_float + 0.055f) / 1.055f, 2.4f);
+    amostra_t amostra;
+    int32_t simulado[3] = {0, 0, 0};
+    int32_t daltonizado[3];
+    preparar_amostra(*r, *g, *b, &amostra);
+#if TABELAS_FILTROS_LUT
+    simular(tipo, severidade, &amostra, simulado);
+#endif
+    daltonizar(tipo, severidade, &amostra, simulado, daltonizado);
 
-    float rgb_linear[3] = {r_float, g_float, b_float};
-    float lms_original[3];
-    float lms_simulated[3];
-    float rgb_simulated_linear[3];
+    uint8_t saida[3];
+    gravar_srgb(daltonizado, saida);
+    *r = saida[0];
+    *g = saida[1];
+    *b = saida[2];
+}
 
-    // 2. Converter RGB linear para LMS
-    multiply_matrix_vector(sRGB_to_LMS_matrix, rgb_linear, lms_original);
+void simular_todos_daltonismos(int severidade, uint8_t r, uint8_t g, uint8_t b,
+                               uint8_t saida[DALTONISMO_NUM_TIPOS + 1][3],
+                               uint8_t daltonizado[DALTONISMO_NUM_TIPOS + 1][3]) {
+    saida[0][0] = r; // Visão normal: a própria cor
+    saida[0][1] = g;
+    saida[0][2] = b;
+    if (daltonizado) {
+        daltonizado[0][0] = r; // Nada a corrigir
+        daltonizado[0][1] = g;
+        daltonizado[0][2] = b;
+    }
+    if ((unsigned)severidade > DALTONISMO_SEVERIDADE_MAX) {
+        severidade = DALTONISMO_SEVERIDADE_MAX;
+    }
+
+    // Linearização (e, no motor LUT, o tetraedro) uma vez só para todos os tipos
+    amostra_t amostra;
+    preparar_amostra(r, g, b, &amostra);
+
+    for (int tipo = 0; tipo < DALTONISMO_NUM_TIPOS; tipo++) {
+        int32_t simulado[3];
+        simular((tipo_daltonismo_t)tipo, severidade, &amostra, simulado);
+        gravar_srgb(simulado, saida[tipo + 1]);
+        if (daltonizado) {
+            int32_t corrigido[3];
+            daltonizar((tipo_daltonismo_t)tipo, severidade, &amostra, simulado, corrigido);
+            gravar_srgb(corrigido, daltonizado[tipo + 1]);
+        }
+    }
+}
+
+// --- Lotes de pixels ---
+// O lote é processado em blocos de FILTRO_LOTE_BLOCO pixels, separados por canal
+// (SoA): linearização, núcleo e saturação viram laços curtos sem desvios, que o
+// compilador desenrola no alvo e vetoriza no PC. Só as consultas às tabelas
+// ficam indexadas.
+#define FILTRO_LOTE_BLOCO 32
+
+// Satura em [0, TRANSFERENCIA_LINEAR_UM] sem desvios (o Cortex-M0+ não tem seleção condicional).
+static inline int32_t saturar_linear(int32_t v) {
+    v &= ~(v >> 31);                                                             // negativo -> 0
+    v -= (v - TRANSFERENCIA_LINEAR_UM) & ((TRANSFERENCIA_LINEAR_UM - v) >> 31); // acima do branco -> branco
+    return v;
+}
 
-    // 3. Aplicar a transformação de daltonismo no espaço LMS
-    multiply_matrix_vector(daltonism_matrix, lms_original, lms_simulated);
+// Filtra, no lugar, n <= FILTRO_LOTE_BLOCO pixels separados por canal.
+static void filtrar_bloco(tipo_daltonismo_t tipo, int severidade, uint8_t canais[3][FILTRO_LOTE_BLOCO], int n) {
+    int32_t linear[3][FILTRO_LOTE_BLOCO];
+    int32_t simulado[3][FILTRO_LOTE_BLOCO];
 
-    // 4. Converter LMS simulado de volta para RGB linear
-    multiply_matrix_vector(LMS_to_sRGB_matrix, lms_simulated, rgb_simulated_linear);
+    for (int c = 0; c < 3; c++) {
+        for (int j = 0; j < n; j++) {
+            linear[c][j] = srgb_para_linear_q12(canais[c][j]);
+        }
+    }
 
-    // 5. Clamping e conversão de volta para RGB (0-255)
-    // Converte de linear para sRGB (inverso do passo 1)
+#if TABELAS_FILTROS_LUT
+    // A escolha do tetraedro depende da cor: aqui fica um pixel por vez.
+    for (int j = 0; j < n; j++) {
+        tetraedro_t tetraedro;
+        int32_t entrada[3] = {linear[0][j], linear[1][j], linear[2][j]};
+        int32_t saida[3];
+        localizar_tetraedro(canais[0][j], canais[1][j], canais[2][j], &tetraedro);
+        simular_lut(tipo, severidade, &tetraedro, entrada, saida);
+        simulado[0][j] = saida[0];
+        simulado[1][j] = saida[1];
+        simulado[2][j] = saida[2];
+    }
+#else
+    const int16_t (*nucleo)[3] = daltonismo_nucleo_q12[tipo][severidade];
     for (int i = 0; i < 3; i++) {
-        float val = rgb_simulated_linear[i];
-        val = (val <= 0.0031308f) ? (val * 12.92f) : (1.055f * powf(val, 1.0f / 2.4f) - 0.055f);
+        const int32_t k0 = nucleo[i][0], k1 = nucleo[i][1], k2 = nucleo[i][2];
+        for (int j = 0; j < n; j++) {
+            int32_t acc = k0 * linear[0][j] + k1 * linear[1][j] + k2 * linear[2][j];
+            simulado[i][j] = (acc + (1 << (TRANSFERENCIA_LINEAR_BITS - 1))) >> TRANSFERENCIA_LINEAR_BITS;
+        }
+    }
+#endif
 
-        // Clamping para garantir que os valores fiquem entre 0 e 1
-        val = fmaxf(0.0f, fminf(1.0f, val));
-        
-        // Converte para 0-255 e arredonda
-        if (i == 0) *r = (uint8_t)roundf(val * 255.0f);
-        else if (i == 1) *g = (uint8_t)roundf(val * 255.0f);
-        else *b = (uint8_t)roundf(val * 255.0f);
+    for (int c = 0; c < 3; c++) {
+        for (int j = 0; j < n; j++) {
+            canais[c][j] = tabela_linear_srgb[saturar_linear(simulado[c][j])];
+        }
     }
 }
 
-// --- Funções Específicas para Cada Tipo de Daltonismo ---
+void filtrar_daltonismo_rgb888(tipo_daltonismo_t tipo, int severidade,
+                               const uint8_t *entrada, uint8_t *saida, size_t pixels) {
+    if ((unsigned)tipo >= DALTONISMO_NUM_TIPOS || (unsigned)severidade > DALTONISMO_SEVERIDADE_MAX) {
+        memmove(saida, entrada, pixels * 3); // Tipo ou severidade desconhecidos: as cores ficam como estão
+        return;
+    }
 
-void aplicar_filtro_protanopia(uint8_t *r, uint8_t *g, uint8_t *b) {
-    aplicar_filtro_generico(r, g, b, protanopia_matrix);
+    uint8_t canais[3][FILTRO_LOTE_BLOCO];
+    while (pixels > 0) {
+        int n = (pixels < FILTRO_LOTE_BLOCO) ? (int)pixels : FILTRO_LOTE_BLOCO;
+        for (int j = 0; j < n; j++) {
+            canais[0][j] = entrada[3 * j];
+            canais[1][j] = entrada[3 * j + 1];
+            canais[2][j] = entrada[3 * j + 2];
+        }
+        filtrar_bloco(tipo, severidade, canais, n);
+        for (int j = 0; j < n; j++) {
+            saida[3 * j] = canais[0][j];
+            saida[3 * j + 1] = canais[1][j];
+            saida[3 * j + 2] = canais[2][j];
+        }
+        entrada += 3 * n;
+        saida += 3 * n;
+        pixels -= n;
+    }
 }
 
-void aplicar_filtro_deuteranopia(uint8_t *r, uint8_t *g, uint8_t *b) {
-    aplicar_filtro_generico(r, g, b, deuteranopia_matrix);
+void filtrar_daltonismo_rgb565(tipo_daltonismo_t tipo, int severidade,
+                               const uint16_t *entrada, uint16_t *saida, size_t pixels) {
+    if ((unsigned)tipo >= DALTONISMO_NUM_TIPOS || (unsigned)severidade > DALTONISMO_SEVERIDADE_MAX) {
+        memmove(saida, entrada, pixels * sizeof(uint16_t));
+        return;
+    }
+
+    uint8_t canais[3][FILTRO_LOTE_BLOCO];
+    while (pixels > 0) {
+        int n = (pixels < FILTRO_LOTE_BLOCO) ? (int)pixels : FILTRO_LOTE_BLOCO;
+        // 5/6 bits -> 8 bits repetindo os bits altos (31 -> 255, 63 -> 255)
+        for (int j = 0; j < n; j++) {
+            uint32_t p = entrada[j];
+            uint32_t r5 = p >> 11, g6 = (p >> 5) & 0x3F, b5 = p & 0x1F;
+            canais[0][j] = (uint8_t)((r5 << 3) | (r5 >> 2));
+            canais[1][j] = (uint8_t)((g6 << 2) | (g6 >> 4));
+            canais[2][j] = (uint8_t)((b5 << 3) | (b5 >> 2));
+        }
+        filtrar_bloco(tipo, severidade, canais, n);
+        // 8 bits -> 5/6 bits com arredondamento: round(v * 31 / 255) e round(v * 63 / 255)
+        for (int j = 0; j < n; j++) {
+            uint32_t r5 = (canais[0][j] * 249u + 1014u) >> 11;
+            uint32_t g6 = (canais[1][j] * 253u + 505u) >> 10;
+            uint32_t b5 = (canais[2][j] * 249u + 1014u) >> 11;
+            saida[j] = (uint16_t)((r5 << 11) | (g6 << 5) | b5);
+        }
+        entrada += n;
+        saida += n;
+        pixels -= n;
+    }
 }
 
-void aplicar_filtro_tritanopia(uint8_t *r, uint8_t *g, uint8_t *b) {
-    aplicar_filtro_generico(r, g, b, tritanopia_matrix);
-}
\ No newline at end of file
+const char *nome_daltonismo(tipo_daltonismo_t tipo, int severidade) {
+    if ((unsigned)tipo >= DALTONISMO_NUM_TIPOS) {
+        return "Normal";
+    }
+    return (severidade >= DALTONISMO_SEVERIDADE_MAX) ? daltonismo_nomes[tipo] : daltonismo_nomes_anomalia[tipo];
+}
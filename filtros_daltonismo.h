@@ -1,21 +1,82 @@
 #ifndef FILTROS_DALTONISMO_H
 #define FILTROS_DALTONISMO_H
 
+#include <stddef.h> // Para size_t
 #include <stdint.h> // Para uint8_t
+#include "tabelas_filtros.h" // tipo_daltonismo_t e os núcleos gerados no build
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-// Funções para aplicar os filtros de daltonismo
-void aplicar_filtro_protanopia(uint8_t *r, uint8_t *g, uint8_t *b);
-void aplicar_filtro_deuteranopia(uint8_t *r, uint8_t *g, uint8_t *b);
-void aplicar_filtro_tritanopia(uint8_t *r, uint8_t *g, uint8_t *b); 
-// Corrected signature, should be:
-void aplicar_filtro_tritanopia(uint8_t *r, uint8_t *g, uint8_t *b);
+/**
+ * @brief Simula um tipo de daltonismo sobre uma cor sRGB (0-255), no lugar.
+ *
+ * Um núcleo 3x3 em Q12 por tipo e severidade, composto no build (RGB -> LMS, projeção,
+ * LMS -> RGB): 9 multiplicações e somas por cor, sem float. Com
+ * COLORVIZ_FILTRO=lut17/lut33, usa a LUT 3D do tipo (interpolação tetraédrica).
+ * @param tipo Tipo de daltonismo (DALTONISMO_PROTANOPIA, ...).
+ * @param severidade Em décimos: 0 (visão normal) a DALTONISMO_SEVERIDADE_MAX (dicromacia).
+ */
+void aplicar_filtro_daltonismo(tipo_daltonismo_t tipo, int severidade, uint8_t *r, uint8_t *g, uint8_t *b);
+
+/**
+ * @brief Daltonização: a cor corrigida para continuar distinguível por quem tem o tipo dado.
+ *
+ * Redistribui o que a simulação perde para os canais que o tipo ainda enxerga
+ * (C = I + E (I - S), Fidaner et al.), em RGB linear Q12. Mesmo custo da simulação:
+ * no motor matriz é outro núcleo 3x3 composto no build.
+ */
+void aplicar_daltonizacao(tipo_daltonismo_t tipo, int severidade, uint8_t *r, uint8_t *g, uint8_t *b);
+
+/**
+ * @brief Simula (e, se pedido, daltoniza) todos os tipos de uma vez sobre a mesma cor.
+ *
+ * Lineariza a cor uma vez e aplica o núcleo (ou a LUT) de cada tipo em seguida:
+ * bem mais barato que chamar aplicar_filtro_daltonismo() para cada um.
+ * @param saida saida[0] = a própria cor (visão normal); saida[n] = tipo n - 1,
+ *              a mesma numeração de modo publicada para a web.
+ * @param daltonizado Cor corrigida, na mesma numeração de 'saida'; NULL se não for usada.
+ */
+void simular_todos_daltonismos(int severidade, uint8_t r, uint8_t g, uint8_t b,
+                               uint8_t saida[DALTONISMO_NUM_TIPOS + 1][3],
+                               uint8_t daltonizado[DALTONISMO_NUM_TIPOS + 1][3]);
+
+/**
+ * @brief Simula um tipo de daltonismo sobre um lote de pixels RGB888 (R, G, B por pixel).
+ *
+ * Mesmo resultado de aplicar_filtro_daltonismo() pixel a pixel, sem o custo de
+ * uma chamada por pixel. 'entrada' e 'saida' podem ser o mesmo buffer (no lugar),
+ * mas não podem se sobrepor de outro jeito.
+ */
+void filtrar_daltonismo_rgb888(tipo_daltonismo_t tipo, int severidade,
+                               const uint8_t *entrada, uint8_t *saida, size_t pixels);
+
+/**
+ * @brief Como filtrar_daltonismo_rgb888(), para pixels RGB565 (R nos bits altos).
+ *
+ * Os canais são expandidos para 8 bits, filtrados e arredondados de volta.
+ */
+void filtrar_daltonismo_rgb565(tipo_daltonismo_t tipo, int severidade,
+                               const uint16_t *entrada, uint16_t *saida, size_t pixels);
+
+static inline void filtrar_daltonismo_rgb888_no_lugar(tipo_daltonismo_t tipo, int severidade,
+                                                      uint8_t *pixels, size_t quantidade) {
+    filtrar_daltonismo_rgb888(tipo, severidade, pixels, pixels, quantidade);
+}
+
+static inline void filtrar_daltonismo_rgb565_no_lugar(tipo_daltonismo_t tipo, int severidade,
+                                                      uint16_t *pixels, size_t quantidade) {
+    filtrar_daltonismo_rgb565(tipo, severidade, pixels, pixels, quantidade);
+}
+
+/**
+ * @brief Nome do tipo na severidade dada: "Protanopia" na máxima, "Protanomalia" abaixo dela.
+ */
+const char *nome_daltonismo(tipo_daltonismo_t tipo, int severidade);
 
 #ifdef __cplusplus
 }
 #endif
 
-#endif // FILTROS_DALTONISMO_H
\ No newline at end of file
+#endif // FILTROS_DALTONISMO_H
@@ -0,0 +1,114 @@
+/**
+ * @file i2c_dma.c
+ * @brief Escalonamento das transferências I2C assíncronas.
+ *
+ * Não acessa hardware: tudo passa pelo backend registrado, o que permite
+ * rodar esta lógica também fora do RP2040.
+ */
+
+#include "i2c_dma.h"
+
+typedef struct {
+    i2c_dma_transferencia_t fila[I2C_DMA_TAMANHO_FILA];
+    uint8_t inicio;     // Índice da próxima transferência pendente
+    uint8_t quantidade; // Transferências pendentes (sem contar a atual)
+    volatile bool ocupado; // Há uma transferência em andamento no hardware
+    i2c_dma_transferencia_t atual;
+} barramento_t;
+
+static barramento_t barramentos[I2C_DMA_NUM_BARRAMENTOS];
+static const i2c_dma_backend_t *backend_atual;
+
+void i2c_dma_init(const i2c_dma_backend_t *backend) {
+    for (int i = 0; i < I2C_DMA_NUM_BARRAMENTOS; i++) {
+        barramentos[i].inicio = 0;
+        barramentos[i].quantidade = 0;
+        barramentos[i].ocupado = false;
+    }
+    backend_atual = backend;
+}
+
+// Retira a próxima da fila e a inicia. Chamado com a seção crítica ativa.
+static void iniciar_proxima(unsigned barramento) {
+    barramento_t *b = &barramentos[barramento];
+    if (b->quantidade == 0) {
+        b->ocupado = false;
+        return;
+    }
+    b->atual = b->fila[b->inicio];
+    b->inicio = (b->inicio + 1) % I2C_DMA_TAMANHO_FILA;
+    b->quantidade--;
+    b->ocupado = true;
+    backend_atual->iniciar(barramento, &b->atual);
+}
+
+bool i2c_dma_enviar(unsigned barramento, const i2c_dma_transferencia_t *t) {
+    barramento_t *b = &barramentos[barramento];
+    uint32_t estado = backend_atual->entrar_critica();
+
+    if (b->quantidade == I2C_DMA_TAMANHO_FILA) {
+        backend_atual->sair_critica(estado);
+        return false;
+    }
+    b->fila[(b->inicio + b->quantidade) % I2C_DMA_TAMANHO_FILA] = *t;
+    b->quantidade++;
+    if (!b->ocupado) {
+        iniciar_proxima(barramento);
+    }
+
+    backend_atual->sair_critica(estado);
+    return true;
+}
+
+typedef struct {
+    volatile bool concluida;
+    volatile i2c_dma_status_t status;
+} espera_t;
+
+static void concluir_espera(i2c_dma_status_t status, void *ctx) {
+    espera_t *espera = (espera_t *)ctx;
+    espera->status = status;
+    espera->concluida = true;
+}
+
+i2c_dma_status_t i2c_dma_transferir(unsigned barramento, const i2c_dma_transferencia_t *t) {
+    espera_t espera = {.concluida = false, .status = I2C_DMA_OK};
+    i2c_dma_transferencia_t copia = *t;
+    copia.callback = concluir_espera;
+    copia.ctx = &espera;
+
+    while (!i2c_dma_enviar(barramento, &copia)) {
+        backend_atual->aguardar_evento(); // Fila cheia: espera uma vaga
+    }
+    while (!espera.concluida) {
+        backend_atual->aguardar_evento();
+    }
+    if (t->callback) {
+        t->callback(espera.status, t->ctx);
+    }
+    return espera.status;
+}
+
+bool i2c_dma_ocupado(unsigned barramento) {
+    return barramentos[barramento].ocupado;
+}
+
+void i2c_dma_aguardar(unsigned barramento) {
+    while (barramentos[barramento].ocupado) {
+        backend_atual->aguardar_evento();
+    }
+}
+
+void i2c_dma_concluir(unsigned barramento, i2c_dma_status_t status) {
+    barramento_t *b = &barramentos[barramento];
+    uint32_t estado = backend_atual->entrar_critica();
+    i2c_dma_callback_t callback = b->atual.callback;
+    void *ctx = b->atual.ctx;
+    // O barramento não fica ocioso entre uma transferência e a próxima.
+    iniciar_proxima(barramento);
+    backend_atual->sair_critica(estado);
+
+    if (callback) {
+        callback(status, ctx);
+    }
+}
@@ -0,0 +1,86 @@
+/**
+ * @file i2c_dma.h
+ * @brief Motor de transferências I2C assíncronas (uma fila por barramento).
+ *
+ * As transferências são enfileiradas e executadas em ordem, uma por vez em
+ * cada barramento; barramentos diferentes (i2c0 e i2c1) rodam em paralelo.
+ * Ao fim de cada transferência o callback é chamado (em contexto de IRQ no
+ * hardware). Este módulo contém apenas o escalonamento: quem move os bytes é
+ * o "backend" registrado em i2c_dma_init() (DMA do RP2040 em i2c_dma_rp2040.c).
+ */
+
+#ifndef I2C_DMA_H
+#define I2C_DMA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define I2C_DMA_NUM_BARRAMENTOS 2 // i2c0 e i2c1
+#define I2C_DMA_TAMANHO_FILA 4    // Transferências pendentes por barramento
+
+typedef enum {
+    I2C_DMA_OK = 0,
+    I2C_DMA_ERRO_ABORTADA, // NACK ou perda de arbitragem (TX_ABRT)
+} i2c_dma_status_t;
+
+typedef void (*i2c_dma_callback_t)(i2c_dma_status_t status, void *ctx);
+
+// Uma transação: escreve 'num_escrita' bytes e, se 'num_leitura' > 0, lê em
+// seguida com repeated start. A transação sempre termina com STOP.
+// Os buffers precisam continuar válidos até o callback ser chamado.
+typedef struct {
+    uint8_t endereco;
+    const uint8_t *escrita;
+    uint16_t num_escrita;
+    uint8_t *leitura;
+    uint16_t num_leitura;
+    i2c_dma_callback_t callback; // Pode ser NULL
+    void *ctx;
+} i2c_dma_transferencia_t;
+
+// Operações que o backend fornece ao escalonador.
+typedef struct {
+    // Começa a transferência no barramento (o barramento está ocioso).
+    void (*iniciar)(unsigned barramento, const i2c_dma_transferencia_t *t);
+    // Seção crítica contra a IRQ de conclusão.
+    uint32_t (*entrar_critica)(void);
+    void (*sair_critica)(uint32_t estado);
+    // Dorme até o próximo evento (IRQ); pode simplesmente retornar.
+    void (*aguardar_evento)(void);
+} i2c_dma_backend_t;
+
+/**
+ * @brief Registra o backend e zera as filas.
+ */
+void i2c_dma_init(const i2c_dma_backend_t *backend);
+
+/**
+ * @brief Enfileira uma transferência (a estrutura é copiada).
+ * @return false se a fila do barramento estiver cheia.
+ */
+bool i2c_dma_enviar(unsigned barramento, const i2c_dma_transferencia_t *t);
+
+/**
+ * @brief Enfileira uma transferência e dorme até ela terminar.
+ * @return O status da transferência.
+ */
+i2c_dma_status_t i2c_dma_transferir(unsigned barramento, const i2c_dma_transferencia_t *t);
+
+/**
+ * @brief Indica se há transferência em andamento ou pendente no barramento.
+ */
+bool i2c_dma_ocupado(unsigned barramento);
+
+/**
+ * @brief Dorme até o barramento esvaziar a fila.
+ */
+void i2c_dma_aguardar(unsigned barramento);
+
+/**
+ * @brief Chamado pelo backend quando a transferência atual termina.
+ * Inicia a próxima da fila e então chama o callback da que terminou.
+ */
+void i2c_dma_concluir(unsigned barramento, i2c_dma_status_t status);
+
+#endif // I2C_DMA_H
@@ -0,0 +1,160 @@
+/**
+ * @file i2c_dma_rp2040.c
+ * @brief Backend de DMA do motor I2C assíncrono.
+ *
+ * Cada barramento usa dois canais de DMA: um alimenta o IC_DATA_CMD com
+ * palavras de comando (byte a escrever ou pedido de leitura, mais os bits de
+ * RESTART/STOP) e outro copia os bytes recebidos. O fim da transação é
+ * detectado pela IRQ do próprio I2C (STOP_DET ou TX_ABRT), e não pelo fim do
+ * DMA, que só indica que os comandos entraram na FIFO.
+ */
+
+#include "i2c_dma_rp2040.h"
+
+#include "pico/stdlib.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+
+// Maior transação suportada: um quadro do OLED (byte de controle + 1024 bytes).
+#define I2C_DMA_MAX_PALAVRAS 1040
+
+typedef struct {
+    i2c_inst_t *i2c;
+    uint canal_tx;
+    uint canal_rx;
+    volatile bool ativa; // Transação em andamento (ignora STOP_DET residual)
+    uint16_t palavras[I2C_DMA_MAX_PALAVRAS];
+} canal_i2c_t;
+
+static canal_i2c_t canais[I2C_DMA_NUM_BARRAMENTOS];
+
+static void rp2040_iniciar(unsigned barramento, const i2c_dma_transferencia_t *t) {
+    canal_i2c_t *c = &canais[barramento];
+    i2c_hw_t *hw = i2c_get_hw(c->i2c);
+    uint total = t->num_escrita + t->num_leitura;
+    hard_assert(total > 0 && total <= I2C_DMA_MAX_PALAVRAS);
+
+    // Monta as palavras de comando do IC_DATA_CMD.
+    uint n = 0;
+    for (uint i = 0; i < t->num_escrita; i++) {
+        c->palavras[n++] = t->escrita[i];
+    }
+    for (uint i = 0; i < t->num_leitura; i++) {
+        uint16_t palavra = I2C_IC_DATA_CMD_CMD_BITS;
+        if (i == 0 && t->num_escrita > 0) {
+            palavra |= I2C_IC_DATA_CMD_RESTART_BITS;
+        }
+        c->palavras[n++] = palavra;
+    }
+    c->palavras[n - 1] |= I2C_IC_DATA_CMD_STOP_BITS;
+
+    // O endereço do alvo só pode ser trocado com o bloco desabilitado.
+    hw->enable = 0;
+    hw->tar = t->endereco;
+    hw->enable = 1;
+    (void)hw->clr_intr;
+    c->ativa = true;
+
+    uint32_t mascara_canais = 1u << c->canal_tx;
+    if (t->num_leitura > 0) {
+        dma_channel_config cfg = dma_channel_get_default_config(c->canal_rx);
+        channel_config_set_transfer_data_size(&cfg, DMA_SIZE_8);
+        channel_config_set_read_increment(&cfg, false);
+        channel_config_set_write_increment(&cfg, true);
+        channel_config_set_dreq(&cfg, i2c_get_dreq(c->i2c, false));
+        dma_channel_configure(c->canal_rx, &cfg, t->leitura, &hw->data_cmd, t->num_leitura, false);
+        mascara_canais |= 1u << c->canal_rx;
+    }
+
+    dma_channel_config cfg = dma_channel_get_default_config(c->canal_tx);
+    channel_config_set_transfer_data_size(&cfg, DMA_SIZE_16);
+    channel_config_set_read_increment(&cfg, true);
+    channel_config_set_write_increment(&cfg, false);
+    channel_config_set_dreq(&cfg, i2c_get_dreq(c->i2c, true));
+    dma_channel_configure(c->canal_tx, &cfg, &hw->data_cmd, c->palavras, n, false);
+
+    dma_start_channel_mask(mascara_canais);
+}
+
+static void rp2040_irq(unsigned barramento) {
+    canal_i2c_t *c = &canais[barramento];
+    i2c_hw_t *hw = i2c_get_hw(c->i2c);
+    uint32_t estado = hw->intr_stat;
+
+    if (estado & I2C_IC_INTR_STAT_R_TX_ABRT_BITS) {
+        // NACK/arbitragem: o hardware descarta a FIFO; interrompe o DMA.
+        dma_channel_abort(c->canal_tx);
+        dma_channel_abort(c->canal_rx);
+        (void)hw->clr_tx_abrt;
+        (void)hw->clr_stop_det;
+        if (c->ativa) {
+            c->ativa = false;
+            i2c_dma_concluir(barramento, I2C_DMA_ERRO_ABORTADA);
+        }
+    } else if (estado & I2C_IC_INTR_STAT_R_STOP_DET_BITS) {
+        (void)hw->clr_stop_det;
+        if (c->ativa) {
+            // O último byte lido pode ainda estar a caminho do buffer.
+            while (dma_channel_is_busy(c->canal_rx) && hw->rxflr > 0) {
+                tight_loop_contents();
+            }
+            c->ativa = false;
+            i2c_dma_concluir(barramento, I2C_DMA_OK);
+        }
+    }
+    __sev(); // Acorda quem está em i2c_dma_aguardar()/i2c_dma_transferir()
+}
+
+static void rp2040_irq_i2c0(void) {
+    rp2040_irq(0);
+}
+
+static void rp2040_irq_i2c1(void) {
+    rp2040_irq(1);
+}
+
+static uint32_t rp2040_entrar_critica(void) {
+    return save_and_disable_interrupts();
+}
+
+static void rp2040_sair_critica(uint32_t estado) {
+    restore_interrupts(estado);
+}
+
+static void rp2040_aguardar_evento(void) {
+    __wfe();
+}
+
+static const i2c_dma_backend_t backend_rp2040 = {
+    .iniciar = rp2040_iniciar,
+    .entrar_critica = rp2040_entrar_critica,
+    .sair_critica = rp2040_sair_critica,
+    .aguardar_evento = rp2040_aguardar_evento,
+};
+
+void i2c_dma_rp2040_init(void) {
+    i2c_inst_t *instancias[I2C_DMA_NUM_BARRAMENTOS] = {i2c0, i2c1};
+    const uint irqs[I2C_DMA_NUM_BARRAMENTOS] = {I2C0_IRQ, I2C1_IRQ};
+    const irq_handler_t handlers[I2C_DMA_NUM_BARRAMENTOS] = {rp2040_irq_i2c0, rp2040_irq_i2c1};
+
+    i2c_dma_init(&backend_rp2040);
+
+    for (int i = 0; i < I2C_DMA_NUM_BARRAMENTOS; i++) {
+        canal_i2c_t *c = &canais[i];
+        i2c_hw_t *hw = i2c_get_hw(instancias[i]);
+        c->i2c = instancias[i];
+        c->canal_tx = dma_claim_unused_channel(true);
+        c->canal_rx = dma_claim_unused_channel(true);
+        c->ativa = false;
+
+        // Pedidos de DMA: TX enquanto a FIFO tiver espaço, RX a cada byte recebido.
+        hw->dma_tdlr = 4;
+        hw->dma_rdlr = 0;
+        hw->dma_cr = I2C_IC_DMA_CR_TDMAE_BITS | I2C_IC_DMA_CR_RDMAE_BITS;
+        hw->intr_mask = I2C_IC_INTR_MASK_M_STOP_DET_BITS | I2C_IC_INTR_MASK_M_TX_ABRT_BITS;
+
+        irq_set_exclusive_handler(irqs[i], handlers[i]);
+        irq_set_enabled(irqs[i], true);
+    }
+}
@@ -0,0 +1,23 @@
+/**
+ * @file i2c_dma_rp2040.h
+ * @brief Backend do motor I2C assíncrono usando DMA e IRQ do RP2040.
+ */
+
+#ifndef I2C_DMA_RP2040_H
+#define I2C_DMA_RP2040_H
+
+#include "hardware/i2c.h"
+#include "i2c_dma.h"
+
+/**
+ * @brief Reserva os canais de DMA de i2c0 e i2c1 e registra o backend.
+ * Deve ser chamada depois de i2c_init() nos dois barramentos.
+ */
+void i2c_dma_rp2040_init(void);
+
+// Índice do barramento usado pela API de i2c_dma.h.
+static inline unsigned i2c_dma_barramento(i2c_inst_t *i2c) {
+    return i2c_hw_index(i2c);
+}
+
+#endif // I2C_DMA_RP2040_H
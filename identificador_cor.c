@@ -1,105 +1,258 @@
 // identificador_cor.c
 #include "identificador_cor.h" // <<< Inclui o novo cabeçalho
-#include <math.h>              // Para sqrtf (square root float)
-#include <float.h>             // Para FLT_MAX (maior valor float)
+#include "ponto_fixo.h"        // Raiz quadrada inteira
+#include "tabelas_cores.h"     // Paleta e tabelas dos motores, geradas no build (tools/gerar_tabelas_cores.py)
 #include <stdio.h>
 
-static float cal_r_m = 1.0826f;  // Inclinação para o canal Vermelho
-static float cal_r_b = -26.065f; // Intercepto para o canal Vermelho
+// O motor de identificação é escolhido no CMake (COLORVIZ_IDENTIFICADOR):
+// LUT 3D para bases pequenas (até 255 cores), árvore k-d para bases grandes
+// ou distância perceptiva em CIELAB.
 
-static float cal_g_m = 1.0279f;  // Inclinação para o canal Verde
-static float cal_g_b = -39.116f; // Intercepto para o canal Verde
+// Só vale para o motor Lab.
+// 1: as melhores candidatas em ΔE76 são reordenadas pelo ΔE2000 (float e trigonometria).
+// 0: só ΔE76, em inteiros. É o padrão enquanto o custo do ΔE2000 por amostra não for
+// medido no RP2040 (ver BANCADA_ORCAMENTO_IDENTIFICACAO_US em bancada.c).
+// No build, vem da opção COLORVIZ_LAB_DELTA_E2000 do CMake.
+#ifndef IDENTIFICADOR_LAB_DELTA_E2000
+#define IDENTIFICADOR_LAB_DELTA_E2000 0
+#endif
 
-static float cal_b_m = 1.6014f; // Inclinação para o canal Azul
-static float cal_b_b = -55.049f;
+// Só vale para o motor Lab com ΔE2000: quantas cores, das mais próximas em ΔE76,
+// passam para a comparação exata em ΔE2000. Com 8, amostras a até ±10 de uma
+// cor da base dão sempre o mesmo resultado que o ΔE2000 contra a base inteira.
+#ifndef IDENTIFICADOR_LAB_CANDIDATAS
+#define IDENTIFICADOR_LAB_CANDIDATAS 8
+#endif
+_Static_assert(IDENTIFICACAO_MAX_CANDIDATAS <= IDENTIFICADOR_LAB_CANDIDATAS,
+               "o pré-filtro Lab precisa de ao menos IDENTIFICACAO_MAX_CANDIDATAS candidatas");
+
+// Abaixo desta confiança (em %), as duas primeiras candidatas são consideradas
+// empatadas: com 10, a segunda está a menos de ~22% além da primeira.
+#ifndef IDENTIFICADOR_CONFIANCA_AMBIGUA
+#define IDENTIFICADOR_CONFIANCA_AMBIGUA 10
+#endif
+
+// Só vale para identificar_cor() com o motor LUT.
+// 1: confirma a cor entre as candidatas da célula (resultado exato).
+// 0: usa só a cor do centro da célula (uma leitura de flash, erro de até meia célula).
+#ifndef IDENTIFICADOR_LUT_REFINAR
+#define IDENTIFICADOR_LUT_REFINAR 1
+#endif
 
 // --- Base de Dados de Cores de Referência ---
-// ESTA É A SEÇÃO ONDE VOCÊ VAI DEFINIR SUAS 100 CORES.
-// Use valores RGB (0-255) que são *representativos* das cores que seu sensor LÊ.
-// Exemplo: Se ao ler um objeto vermelho, seu sensor normalizado dá R=200, G=30, B=20, use esses.
-const CorReferencia base_dados_cores[] = { 
-    {"rosa choque", 191, 96, 147, 255, 20, 147},
-    {"vermelho", 168, 73, 76, 255, 0, 0},
-    {"vinho", 71, 66, 66, 90, 0, 0},
-
-    {"laranja claro", 252, 193, 147, 255, 156, 64},
-    {"laranja", 234, 137, 104, 255, 119, 0},
-    {"laranja escuro", 206, 96, 84, 255, 77, 0},
-
-    {"amarelo claro", 255, 255, 206, 247, 255, 99},
-    {"amarelo", 255, 255, 168, 255, 255, 0},
-    {"mostarda", 196, 193, 114, 205, 173, 0},
-
-    {"verde claro", 175, 255, 239, 152, 255, 152},
-    {"verde", 112, 209, 140, 7, 245, 7},
-    {"verde militar", 63, 96, 76, 58, 105, 22},
-    {"verde escuro", 50, 78, 232, 6, 59, 8},
-    {"verde água", 99, 186, 153, 21, 189, 116},
-
-    {"azul bebe", 155, 255, 255, 135, 206, 235},
-    {"azul ceu", 71, 147, 232, 0, 94, 255},
-    {"azul marinho", 40, 84, 127, 0, 0, 128},
-    {"azul petroleo", 45, 71, 79, 3, 17, 41},
-
-    {"lilas", 188, 242, 255, 200, 162, 200},
-    {"roxo", 96, 91, 147, 128, 0, 128},
-    {"violeta", 58, 86, 112, 58, 23, 87},
-
-    {"cinza claro", 173, 249, 252, 172, 176, 174},
-    {"cinza", 81, 119, 117, 87, 97, 88},
-    {"cinza escuro", 63, 91, 94, 49, 59, 59},
-    {"preto", 40, 61, 58, 0, 0, 0},
-
-    {"areia", 219, 255, 232, 222, 203, 164},
-    {"marrom", 89, 84, 71, 139, 69, 19},
-    {"marrom escuro", 58, 73, 68, 79, 44, 21},
-
-    {"rosa chiclete", 211, 150, 193, 255, 105, 180},
-    {"rosa bebe", 245, 245, 235, 247, 181, 173},
-    {"branco", 255, 255, 255, 255, 255, 255}
-
-};
-
-// Calcula o número de cores na base de dados automaticamente
-const int NUM_CORES_NA_BASE_DADOS = sizeof(base_dados_cores) / sizeof(CorReferencia); // <<< Renomeado
+// As cores ficam em paleta_cores.csv. O build gera tabelas_cores.c com a paleta em
+// vetores separados (RGB do sensor, RGB ideal, Lab e nomes), além das tabelas dos motores.
 
-// Função para identificar a cor mais próxima
-const char *identificar_cor(uint8_t *r_norm, uint8_t *g_norm, uint8_t *b_norm)
+#if TABELAS_CORES_LUT
+_Static_assert(IDENTIFICACAO_MAX_CANDIDATAS <= LUT_CORES_VIZINHOS,
+               "os conjuntos da LUT precisam cobrir IDENTIFICACAO_MAX_CANDIDATAS vizinhas");
+
+static uint32_t distancia2(uint8_t r, uint8_t g, uint8_t b, const uint8_t cor[3])
+{
+    int32_t dr = (int32_t)r - cor[0];
+    int32_t dg = (int32_t)g - cor[1];
+    int32_t db = (int32_t)b - cor[2];
+    return (uint32_t)(dr * dr + dg * dg + db * db);
+}
+#endif
+
+#if TABELAS_CORES_LAB
+// Converte a amostra uma vez para Lab, ordena a base por ΔE76 (inteiro) e, com
+// IDENTIFICADOR_LAB_DELTA_E2000, decide entre as melhores candidatas com ΔE2000.
+// Preenche até k candidatas ordenadas pela métrica usada (distância em 1/16 de ΔE)
+// e devolve quantas preencheu.
+static int candidatas_lab(uint8_t r, uint8_t g, uint8_t b, candidata_cor_t *saida, int k)
 {
-    float menor_distancia = FLT_MAX;
-    const char *nome_cor_identificada = "Desconhecida";
-    int indice_cor_mais_proxima = -1;
+    cor_lab_t amostra;
+    cor_lab_de_rgb(r, g, b, &amostra);
 
-    for (int i = 0; i < NUM_CORES_NA_BASE_DADOS; i++)
+    int candidatas[IDENTIFICADOR_LAB_CANDIDATAS];
+    uint32_t distancias[IDENTIFICADOR_LAB_CANDIDATAS];
+    int quantidade = 0;
+    for (int i = 0; i < TABELAS_CORES_NUM_CORES; i++)
     {
-        float dr = (float)(*r_norm) - base_dados_cores[i].r;
-        float dg = (float)(*g_norm) - base_dados_cores[i].g;
-        float db = (float)(*b_norm) - base_dados_cores[i].b;
+        uint32_t distancia = cor_lab_delta_e76_2(&amostra, &lab_cores[i]);
+        if (quantidade == IDENTIFICADOR_LAB_CANDIDATAS && distancia >= distancias[quantidade - 1])
+        {
+            continue;
+        }
+        int pos = (quantidade < IDENTIFICADOR_LAB_CANDIDATAS) ? quantidade++ : quantidade - 1;
+        while (pos > 0 && distancias[pos - 1] > distancia)
+        {
+            distancias[pos] = distancias[pos - 1];
+            candidatas[pos] = candidatas[pos - 1];
+            pos--;
+        }
+        distancias[pos] = distancia;
+        candidatas[pos] = i;
+    }
 
-        float distancia = sqrtf(dr * dr + dg * dg + db * db);
+#if IDENTIFICADOR_LAB_DELTA_E2000
+    // Reordena as candidatas por ΔE2000, guardando só as k melhores.
+    int preenchidas = 0;
+    for (int c = 0; c < quantidade; c++)
+    {
+        float delta = cor_lab_delta_e2000(&amostra, &lab_cores[candidatas[c]]);
+        uint32_t distancia = (uint32_t)(delta * IDENTIFICACAO_DISTANCIA_ESCALA + 0.5f);
+        if (preenchidas == k && distancia >= saida[k - 1].distancia)
+        {
+            continue;
+        }
+        int pos = (preenchidas < k) ? preenchidas++ : k - 1;
+        while (pos > 0 && saida[pos - 1].distancia > distancia)
+        {
+            saida[pos] = saida[pos - 1];
+            pos--;
+        }
+        saida[pos].indice = (uint16_t)candidatas[c];
+        saida[pos].distancia = (uint16_t)(distancia > UINT16_MAX ? UINT16_MAX : distancia);
+    }
+#else
+    // Já estão em ordem de ΔE76: só passa a distância de 1/64 para 1/16 de ΔE.
+    int preenchidas = (quantidade < k) ? quantidade : k;
+    for (int c = 0; c < preenchidas; c++)
+    {
+        uint32_t distancia = (raiz_quadrada_u32(distancias[c]) + 2) / (COR_LAB_ESCALA / IDENTIFICACAO_DISTANCIA_ESCALA);
+        saida[c].indice = (uint16_t)candidatas[c];
+        saida[c].distancia = (uint16_t)(distancia > UINT16_MAX ? UINT16_MAX : distancia);
+    }
+#endif
+    return preenchidas;
+}
+#elif TABELAS_CORES_LUT
+// k mais próximas em RGB entre as candidatas da célula da LUT. O conjunto tem toda
+// cor que pode estar entre as LUT_CORES_VIZINHOS mais próximas de algum ponto da
+// célula, então o resultado é o da varredura da base inteira (empate fica com a
+// primeira), sem descer a árvore. Distância euclidiana em 1/16 de unidade.
+static int candidatas_lut(uint8_t r, uint8_t g, uint8_t b, candidata_cor_t *saida, int k)
+{
+    uint32_t celula = LUT_CORES_CELULA(r, g, b);
+    uint16_t conjunto = lut_cores_conjunto[celula];
+    uint32_t distancias[IDENTIFICACAO_MAX_CANDIDATAS];
+    int preenchidas = 0;
 
-        if (distancia < menor_distancia)
+    if (conjunto == 0)
+    {
+        saida[0].indice = lut_cores_indice[celula];
+        distancias[0] = distancia2(r, g, b, cores_rgb_sensor[saida[0].indice]);
+        preenchidas = 1;
+    }
+    else
+    {
+        for (uint16_t c = lut_cores_conjunto_inicio[conjunto - 1]; c < lut_cores_conjunto_inicio[conjunto]; c++)
         {
-            menor_distancia = distancia;
-            nome_cor_identificada = base_dados_cores[i].nome;
-            indice_cor_mais_proxima = i;
+            uint8_t i = lut_cores_candidatas[c];
+            uint32_t distancia = distancia2(r, g, b, cores_rgb_sensor[i]);
+            if (preenchidas == k && distancia >= distancias[k - 1])
+            {
+                continue;
+            }
+            int pos = (preenchidas < k) ? preenchidas++ : k - 1;
+            while (pos > 0 && distancias[pos - 1] > distancia)
+            {
+                distancias[pos] = distancias[pos - 1];
+                saida[pos] = saida[pos - 1];
+                pos--;
+            }
+            distancias[pos] = distancia;
+            saida[pos].indice = i;
         }
     }
 
-    if (indice_cor_mais_proxima >= 0)
+    for (int i = 0; i < preenchidas; i++)
+    {
+        saida[i].distancia = (uint16_t)raiz_quadrada_u32(distancias[i] *
+                                                         (IDENTIFICACAO_DISTANCIA_ESCALA * IDENTIFICACAO_DISTANCIA_ESCALA));
+    }
+    return preenchidas;
+}
+#else
+// k vizinhos mais próximos em RGB, numa única descida da árvore k-d
+// (distância euclidiana em 1/16 de unidade).
+static int candidatas_rgb(uint8_t r, uint8_t g, uint8_t b, candidata_cor_t *saida, int k)
+{
+    vizinho_cor_t vizinhos[IDENTIFICACAO_MAX_CANDIDATAS];
+    int quantidade = arvore_cores_k_mais_proximas(&arvore_cores, r, g, b, vizinhos, k);
+    for (int i = 0; i < quantidade; i++)
+    {
+        saida[i].indice = vizinhos[i].indice;
+        saida[i].distancia = (uint16_t)raiz_quadrada_u32(vizinhos[i].distancia2 *
+                                                         (IDENTIFICACAO_DISTANCIA_ESCALA * IDENTIFICACAO_DISTANCIA_ESCALA));
+    }
+    return quantidade;
+}
+#endif
+
+// Função para identificar a cor mais próxima
+const char *identificar_cor(uint8_t *r_norm, uint8_t *g_norm, uint8_t *b_norm)
+{
+#if TABELAS_CORES_LAB
+    candidata_cor_t melhor;
+    candidatas_lab(*r_norm, *g_norm, *b_norm, &melhor, 1);
+    int indice_cor_mais_proxima = melhor.indice;
+#elif TABELAS_CORES_LUT
+    // Uma leitura da LUT 3D (em flash) dá a cor mais próxima do centro da célula.
+    uint32_t celula = LUT_CORES_CELULA(*r_norm, *g_norm, *b_norm);
+    int indice_cor_mais_proxima = lut_cores_indice[celula];
+
+#if IDENTIFICADOR_LUT_REFINAR
+    // Compara só com as poucas cores candidatas da célula.
+    // Mesmo critério da busca completa (menor distância; empate fica com a primeira),
+    // então o resultado é idêntico ao da varredura de toda a base.
+    uint16_t conjunto = lut_cores_conjunto[celula];
+    if (conjunto != 0)
     {
-        *r_norm = base_dados_cores[indice_cor_mais_proxima].r_ideal;
-        *g_norm = base_dados_cores[indice_cor_mais_proxima].g_ideal;
-        *b_norm = base_dados_cores[indice_cor_mais_proxima].b_ideal;
+        uint32_t menor_distancia = UINT32_MAX;
+        for (uint16_t k = lut_cores_conjunto_inicio[conjunto - 1]; k < lut_cores_conjunto_inicio[conjunto]; k++)
+        {
+            uint8_t i = lut_cores_candidatas[k];
+            uint32_t distancia = distancia2(*r_norm, *g_norm, *b_norm, cores_rgb_sensor[i]);
+            if (distancia < menor_distancia)
+            {
+                menor_distancia = distancia;
+                indice_cor_mais_proxima = i;
+            }
+        }
     }
+#endif
+#else
+    // Busca com poda na árvore k-d: mesmo resultado da varredura linear, em O(log n) típico.
+    int indice_cor_mais_proxima = arvore_cores_mais_proxima(&arvore_cores, *r_norm, *g_norm, *b_norm);
+#endif
+
+    *r_norm = cores_rgb_ideal[indice_cor_mais_proxima][0];
+    *g_norm = cores_rgb_ideal[indice_cor_mais_proxima][1];
+    *b_norm = cores_rgb_ideal[indice_cor_mais_proxima][2];
 
-    return nome_cor_identificada;
+    return tabelas_cores_nome(indice_cor_mais_proxima);
 }
 
-void aplicar_calibacao_rgb(uint8_t *r, uint8_t *g, uint8_t *b)
+void identificar_cor_candidatas(uint8_t r, uint8_t g, uint8_t b, int k, identificacao_cor_t *resultado)
 {
-    // Aplica a função linear (y = m*x + b) e garante que o valor permaneça entre 0 e 255.
-    *r = (uint8_t)fminf(255.0f, fmaxf(0.0f, (*r * cal_r_m) + cal_r_b));
-    *g = (uint8_t)fminf(255.0f, fmaxf(0.0f, (*g * cal_g_m) + cal_g_b));
-    *b = (uint8_t)fminf(255.0f, fmaxf(0.0f, (*b * cal_b_m) + cal_b_b));
-}
\ No newline at end of file
+    if (k < 1)
+    {
+        k = 1;
+    }
+    if (k > IDENTIFICACAO_MAX_CANDIDATAS)
+    {
+        k = IDENTIFICACAO_MAX_CANDIDATAS;
+    }
+    // A confiança compara as duas primeiras, então a busca pede pelo menos duas.
+    int busca = (k < 2) ? 2 : k;
+
+#if TABELAS_CORES_LAB
+    int encontradas = candidatas_lab(r, g, b, resultado->candidatas, busca);
+#elif TABELAS_CORES_LUT
+    int encontradas = candidatas_lut(r, g, b, resultado->candidatas, busca);
+#else
+    int encontradas = candidatas_rgb(r, g, b, resultado->candidatas, busca);
+#endif
+
+    // Confiança: separação relativa entre a primeira e a segunda candidata,
+    // (d2 - d1) / (d2 + d1). 100 quando a segunda está muito mais longe; 0 no empate.
+    uint32_t d1 = resultado->candidatas[0].distancia;
+    uint32_t d2 = (encontradas > 1) ? resultado->candidatas[1].distancia : UINT16_MAX;
+    resultado->confianca = (d1 + d2 == 0) ? 0 : (uint8_t)((100 * (d2 - d1)) / (d2 + d1));
+    resultado->ambigua = (encontradas > 1) && (resultado->confianca < IDENTIFICADOR_CONFIANCA_AMBIGUA);
+    resultado->quantidade = (uint8_t)((encontradas < k) ? encontradas : k);
+}
@@ -3,13 +3,9 @@
 #define IDENTIFICADOR_COR_H
 
 #include <stdint.h> // Para uint8_t
+#include <stdbool.h>
 
-// Estrutura para definir uma cor de referência com seu nome e valores RGB normalizados
-typedef struct {
-    const char *nome; // Usamos 'const char *' para strings literais na memória flash
-    uint8_t r, g, b;           // Valor lido pelo sensor
-    uint8_t r_ideal, g_ideal, b_ideal;  // Valor perceptivo ideal
-} CorReferencia;
+// As cores de referência vêm de paleta_cores.csv; as tabelas geradas estão em tabelas_cores.h.
 
 // Função para identificar a cor mais próxima a partir de valores RGB normalizados
 /**
@@ -19,7 +15,36 @@ typedef struct {
  * @param b_norm Valor B normalizado (0-255).
  * @return Um ponteiro para uma string constante contendo o nome da cor identificada.
  * Retorna "Desconhecida" se nenhuma cor próxima for encontrada (limiar não implementado ainda).
+ * @note Substitui r/g/b pelo RGB ideal da cor identificada. Para a cor sem
+ * alteração, as alternativas e a confiança, use identificar_cor_candidatas().
  */
 const char* identificar_cor(uint8_t *r_norm, uint8_t *g_norm, uint8_t *b_norm);
-void aplicar_calibacao_rgb(uint8_t *r, uint8_t *g, uint8_t *b);
+
+#define IDENTIFICACAO_MAX_CANDIDATAS 4
+#define IDENTIFICACAO_DISTANCIA_ESCALA 16 // Distâncias em 1/16 de unidade da métrica do motor
+
+// Uma cor candidata da paleta (nome e RGB ideal em tabelas_cores.h).
+typedef struct {
+    uint16_t indice;    // Posição na paleta
+    uint16_t distancia; // RGB euclidiano ou ΔE (motor lab), em 1/IDENTIFICACAO_DISTANCIA_ESCALA
+} candidata_cor_t;
+
+typedef struct {
+    candidata_cor_t candidatas[IDENTIFICACAO_MAX_CANDIDATAS]; // Da mais próxima para a mais distante
+    uint8_t quantidade; // Candidatas válidas
+    uint8_t confianca;  // 0-100: separação entre a primeira e a segunda candidata
+    bool ambigua;       // As duas primeiras estão perto demais para decidir
+} identificacao_cor_t;
+
+/**
+ * @brief Identifica as k cores mais próximas, sem alterar a amostra.
+ *
+ * Uma única busca no motor configurado (candidatas da célula no motor LUT,
+ * árvore k-d no kdtree, ΔE76 no motor lab, mais ΔE2000 com
+ * IDENTIFICADOR_LAB_DELTA_E2000); nenhuma varredura extra da paleta.
+ * @param k Candidatas desejadas (1 a IDENTIFICACAO_MAX_CANDIDATAS).
+ * @param resultado Candidatas ordenadas, confiança e indicação de ambiguidade.
+ */
+void identificar_cor_candidatas(uint8_t r, uint8_t g, uint8_t b, int k, identificacao_cor_t *resultado);
+
 #endif // IDENTIFICADOR_COR_H
\ No newline at end of file
@@ -5,11 +5,32 @@
 #include "pico/stdlib.h"
 #include "pico/binary_info.h"
 #include "hardware/i2c.h"
+#include "hardware/sync.h"
 #include "ssd1306_font.h"
 #include "ssd1306_i2c.h"
+#include "i2c_dma_rp2040.h"
 
 uint8_t ssd1306_buffer[SSD1306_BUFFER_LENGTH];
 
+// Cópia do quadro que o DMA está enviando (byte de controle 0x40 + dados), para
+// que o buffer de desenho possa ser alterado enquanto o envio acontece.
+static uint8_t quadro_envio[SSD1306_BUFFER_LENGTH + 1];
+static volatile bool quadro_em_envio = false;
+
+static void ssd1306_quadro_enviado(i2c_dma_status_t status, void *ctx) {
+    quadro_em_envio = false;
+}
+
+// Escrita curta (comandos): enfileira no motor I2C e espera terminar
+static void ssd1306_write(i2c_inst_t *i2c, uint8_t address, const uint8_t *dados, size_t len) {
+    i2c_dma_transferencia_t t = {
+        .endereco = address,
+        .escrita = dados,
+        .num_escrita = len,
+    };
+    i2c_dma_transferir(i2c_dma_barramento(i2c), &t);
+}
+
 // Calcular quanto do buffer será destinado à área de renderização
 void calculate_render_area_buffer_length(struct render_area *area) {
     area->buffer_length = (area->end_column - area->start_column + 1) * (area->end_page - area->start_page + 1);
@@ -19,7 +40,7 @@ void calculate_render_area_buffer_length(struct render_area *area) {
 // Processo de escrita do i2c espera um byte de controle, seguido por dados
 void ssd1306_send_command(uint8_t command) {
     uint8_t buffer[2] = {0x80, command};
-    i2c_write_blocking(i2c1, ssd1306_i2c_address, buffer, 2, false);
+    ssd1306_write(i2c1, ssd1306_i2c_address, buffer, 2);
 }
 
 // Envia uma lista de comandos ao hardware
@@ -29,16 +50,27 @@ void ssd1306_send_command_list(uint8_t *ssd, int number) {
     }
 }
 
-// Copia buffer de referência num novo buffer, a fim de adicionar o byte de controle desde o início
+// Copia buffer de referência num novo buffer, a fim de adicionar o byte de controle desde o início.
+// O envio é feito por DMA: a função retorna assim que o quadro entra na fila do motor I2C.
 void ssd1306_send_buffer(uint8_t ssd[], int buffer_length) {
-    uint8_t *temp_buffer = malloc(buffer_length + 1);
-
-    temp_buffer[0] = 0x40;
-    memcpy(temp_buffer + 1, ssd, buffer_length);
+    // Só espera se o quadro anterior ainda estiver sendo enviado.
+    while (quadro_em_envio) {
+        i2c_dma_aguardar(i2c_dma_barramento(i2c1));
+    }
 
-    i2c_write_blocking(i2c1, ssd1306_i2c_address, temp_buffer, buffer_length + 1, false);
+    quadro_envio[0] = 0x40;
+    memcpy(quadro_envio + 1, ssd, buffer_length);
 
-    free(temp_buffer);
+    i2c_dma_transferencia_t t = {
+        .endereco = ssd1306_i2c_address,
+        .escrita = quadro_envio,
+        .num_escrita = buffer_length + 1,
+        .callback = ssd1306_quadro_enviado,
+    };
+    quadro_em_envio = true;
+    while (!i2c_dma_enviar(i2c_dma_barramento(i2c1), &t)) {
+        __wfe(); // Fila cheia: espera uma vaga
+    }
 }
 
 // Cria a lista de comandos (com base nos endereços definidos em ssd1306_i2c.h) para a inicialização do display
@@ -180,8 +212,7 @@ void ssd1306_draw_string(uint8_t *ssd, int16_t x, int16_t y, char *string) {
 // Comando de configuração com base na estrutura ssd1306_t
 void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
   ssd->port_buffer[1] = command;
-  i2c_write_blocking(
-	ssd->i2c_port, ssd->address, ssd->port_buffer, 2, false );
+  ssd1306_write(ssd->i2c_port, ssd->address, ssd->port_buffer, 2);
 }
 
 // Função de configuração do display para o caso do bitmap
@@ -234,8 +265,7 @@ void ssd1306_send_data(ssd1306_t *ssd) {
     ssd1306_command(ssd, ssd1306_set_page_address);
     ssd1306_command(ssd, 0);
     ssd1306_command(ssd, ssd->pages - 1);
-    i2c_write_blocking(
-    ssd->i2c_port, ssd->address, ssd->ram_buffer, ssd->bufsize, false );
+    ssd1306_write(ssd->i2c_port, ssd->address, ssd->ram_buffer, ssd->bufsize);
 }
 
 // Desenha o bitmap (a ser fornecido em display_oled.c) no display
@@ -249,6 +279,7 @@ void ssd1306_draw_bitmap(ssd1306_t *ssd, const uint8_t *bitmap) {
 void limpar_oled()
 {
     // Usamos ssd1306_buffer, o buffer global do driver
-    memset(ssd1306_buffer, 0, SSD1306_BUFFER_LENGTH);           // Preenche o buffer global com zeros
-    ssd1306_send_buffer(ssd1306_buffer, ssd1306_buffer_length); // Envia o buffer limpo para o display
+    // Só limpa o buffer: quem desenha a tela envia o quadro completo depois,
+    // evitando enviar um quadro vazio (e piscar) a cada redesenho.
+    memset(ssd1306_buffer, 0, SSD1306_BUFFER_LENGTH); // Preenche o buffer global com zeros
 }
\ No newline at end of file
@@ -20,7 +20,9 @@
 #endif
 #define MEM_ALIGNMENT               4
 #define MEM_SIZE                    4000
-#define MEMP_NUM_TCP_SEG            32
+// Servidor HTTP: até 8 conexões (core1.c), mais 4 assinantes SSE e 2 clientes WebSocket
+#define MEMP_NUM_TCP_PCB            16
+#define MEMP_NUM_TCP_SEG            64
 #define MEMP_NUM_ARP_QUEUE          10
 #define PBUF_POOL_SIZE              24
 #define LWIP_ARP                    1
@@ -47,7 +49,9 @@
 #define LWIP_UDP                    1
 #define LWIP_DNS                    1
 #define LWIP_TCP_KEEPALIVE          1
-#define LWIP_NETIF_TX_SINGLE_PBUF   1
+// Com 1, tcp_write() copia sempre os dados; com 0, os eventos SSE (eventos_sse.c)
+// saem sem cópia do pbuf compartilhado. O driver CYW43 aceita cadeias de pbufs.
+#define LWIP_NETIF_TX_SINGLE_PBUF   0
 #define DHCP_DOES_ARP_CHECK         0
 #define LWIP_DHCP_DOES_ACD_CHECK    0
 
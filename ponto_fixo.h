@@ -0,0 +1,40 @@
+// ponto_fixo.h
+// Aritmética em ponto fixo Q16 (16 bits de fração). O RP2040 não tem FPU:
+// cada operação em float vira uma chamada de rotina de software.
+#ifndef PONTO_FIXO_H
+#define PONTO_FIXO_H
+
+#include <stdint.h>
+
+#define Q16_UM (1 << 16)
+
+// Converte uma constante float para Q16, com arredondamento. Usada com literais,
+// é avaliada pelo compilador: nenhuma conta em float sobra no firmware.
+#define Q16(x) ((int32_t)((x) * 65536.0 + ((x) >= 0 ? 0.5 : -0.5)))
+
+// Raiz quadrada inteira (parte inteira), bit a bit: sem divisões nem float.
+static inline uint32_t raiz_quadrada_u32(uint32_t v)
+{
+    uint32_t raiz = 0;
+    uint32_t bit = 1u << 30;
+    while (bit > v)
+    {
+        bit >>= 2;
+    }
+    while (bit != 0)
+    {
+        if (v >= raiz + bit)
+        {
+            v -= raiz + bit;
+            raiz = (raiz >> 1) + bit;
+        }
+        else
+        {
+            raiz >>= 1;
+        }
+        bit >>= 2;
+    }
+    return raiz;
+}
+
+#endif // PONTO_FIXO_H
@@ -0,0 +1,92 @@
+// shared_data.c
+// Anel de amostras do Core 0 (sensor) para o Core 1 (rede), sem trava:
+// um produtor, um consumidor, e a FIFO entre os núcleos como campainha.
+#include <string.h>
+
+#include "hardware/sync.h"  // __dmb
+#include "hardware/timer.h" // time_us_64
+#include "pico/multicore.h" // FIFO entre os núcleos
+#include "shared_data.h"
+
+volatile int shared_severidade = DALTONISMO_SEVERIDADE_MAX;
+
+// Palavra enviada pela FIFO; o valor não importa, só a chegada.
+#define ANEL_AMOSTRAS_SINAL 0xC0105A11u
+
+static amostra_cor_t anel[ANEL_AMOSTRAS_CAPACIDADE];
+// Contadores livres (a posição é o contador módulo a capacidade): 'escrita' só muda
+// no Core 0, 'leitura' só no Core 1. Cheio quando escrita - leitura == capacidade.
+static volatile uint32_t escrita = 0;
+static volatile uint32_t leitura = 0;
+static volatile uint32_t perdidas = 0;
+static uint32_t sequencia = 0; // Só o Core 0 usa
+
+bool anel_amostras_publicar(const snapshot_cor_t *cor) {
+    sequencia++;
+    uint32_t e = escrita;
+    if (e - leitura == ANEL_AMOSTRAS_CAPACIDADE) {
+        perdidas++;
+        return false;
+    }
+    amostra_cor_t *amostra = &anel[e % ANEL_AMOSTRAS_CAPACIDADE];
+    amostra->sequencia = sequencia;
+    amostra->tempo_us = time_us_64();
+    memcpy(&amostra->cor, cor, sizeof(amostra->cor));
+    __dmb(); // A amostra fica visível antes do novo índice
+    escrita = e + 1;
+
+    // Uma palavra pendente já basta: com a FIFO cheia, não há o que esperar.
+    if (multicore_fifo_wready()) {
+        multicore_fifo_push_blocking(ANEL_AMOSTRAS_SINAL);
+    }
+    return true;
+}
+
+bool anel_amostras_campainha(void) {
+    bool tocou = false;
+    while (multicore_fifo_rvalid()) {
+        multicore_fifo_pop_blocking();
+        tocou = true;
+    }
+    return tocou;
+}
+
+bool anel_amostras_retirar(amostra_cor_t *amostra) {
+    uint32_t l = leitura;
+    if (l == escrita) {
+        return false;
+    }
+    __dmb(); // Lê a amostra só depois de ver o índice que a publicou
+    memcpy(amostra, &anel[l % ANEL_AMOSTRAS_CAPACIDADE], sizeof(*amostra));
+    __dmb(); // Termina a cópia antes de liberar a posição para o Core 0
+    leitura = l + 1;
+    return true;
+}
+
+uint32_t anel_amostras_perdidas(void) {
+    return perdidas;
+}
+
+// Pedido de modo: o Core 1 grava o valor e depois o contador; o Core 0 atende
+// quando o contador muda. Um pedido que chega no meio da leitura só faz o mesmo
+// valor ser aplicado duas vezes.
+static volatile int modo_pedido = 0;
+static volatile uint32_t pedidos_modo = 0;
+
+void pedir_modo_web(int modo) {
+    modo_pedido = modo;
+    __dmb(); // O valor fica visível antes do contador
+    pedidos_modo = pedidos_modo + 1;
+}
+
+bool modo_web_pedido(int *modo) {
+    static uint32_t pedidos_atendidos = 0;
+    uint32_t pedidos = pedidos_modo;
+    if (pedidos == pedidos_atendidos) {
+        return false;
+    }
+    __dmb();
+    *modo = modo_pedido;
+    pedidos_atendidos = pedidos;
+    return true;
+}
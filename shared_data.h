@@ -1,25 +1,88 @@
 #ifndef SHARED_DATA_H
 #define SHARED_DATA_H
 
+#include <stdbool.h>
 #include <stdint.h>
-#include "pico/sync.h" // Para mutex_t
+#include "identificador_cor.h" // Para identificacao_cor_t
+#include "tabelas_filtros.h" // Para DALTONISMO_NUM_TIPOS
 
-// Variáveis globais voláteis para os dados de cor
-// 'volatile' é crucial para garantir que o compilador não otimize o acesso
-// a essas variáveis, pois elas podem ser alteradas por outro núcleo.
-extern volatile uint8_t shared_r_corrigido;
-extern volatile uint8_t shared_g_corrigido;
-extern volatile uint8_t shared_b_corrigido;
-extern volatile char shared_color_name[32]; // Buffer para o nome da cor
-extern volatile int shared_daltonism_mode; // 0=Normal, 1=Protanopia, 2=Deuteranopia, 3=Tritanopia
+// Tudo o que o Core 0 publica para o servidor web (Core 1) num quadro.
+typedef struct {
+    int modo;       // Modo escolhido no aparelho: 0=Normal, n=tipo_daltonismo_t n-1
+    int severidade; // Severidade aplicada, em décimos
+    // Cor em todos os modos, calculados juntos a cada quadro: [0] = Normal, [n] = tipo n-1.
+    uint8_t rgb_modos[DALTONISMO_NUM_TIPOS + 1][3];
+    // Cor corrigida (daltonização) para cada modo, na mesma numeração; [0] é a própria cor.
+    uint8_t rgb_daltonizado[DALTONISMO_NUM_TIPOS + 1][3];
+    // Candidatas da última identificação (alternativas, confiança, ambiguidade)
+    identificacao_cor_t identificacao;
+    // Muda só quando a identidade publicada muda (cor, alternativas, ambiguidade, modo
+    // ou severidade): quem desenha pode pular o redesenho enquanto ela for a mesma.
+    uint32_t versao_identidade;
+} snapshot_cor_t;
 
-// Mutex para proteger o acesso aos dados compartilhados
-extern mutex_t shared_data_mutex;
+// Severidade pedida, em décimos (0 = normal a DALTONISMO_SEVERIDADE_MAX = dicromacia).
+// Escrita pelo menu (Core 0) ou por GET /api/severidade (Core 1); lida pelo Core 0 a cada
+// quadro. Uma palavra alinhada: leitura e escrita já são atômicas, sem trava.
+extern volatile int shared_severidade;
+
+// Uma amostra no anel do Core 0 para o Core 1.
+typedef struct {
+    uint32_t sequencia; // 1, 2, 3... na ordem de publicação, contando as perdidas
+    uint64_t tempo_us;  // time_us_64() no momento da publicação
+    snapshot_cor_t cor;
+} amostra_cor_t;
+
+// Amostras guardadas no anel; potência de 2. A 15-20 quadros/s, pouco mais de 1,5 s
+// de folga para o Core 1 ficar sem consumir.
+#ifndef ANEL_AMOSTRAS_CAPACIDADE
+#define ANEL_AMOSTRAS_CAPACIDADE 32
+#endif
+_Static_assert((ANEL_AMOSTRAS_CAPACIDADE & (ANEL_AMOSTRAS_CAPACIDADE - 1)) == 0,
+               "ANEL_AMOSTRAS_CAPACIDADE precisa ser potência de 2");
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ * @brief Publica uma amostra no anel (só o Core 0 escreve). Nunca bloqueia.
+ *
+ * Com o anel cheio, a amostra é descartada e contada em anel_amostras_perdidas().
+ * Depois de gravar, toca a campainha: uma palavra na FIFO entre os núcleos.
+ * @return false se a amostra foi descartada.
+ */
+bool anel_amostras_publicar(const snapshot_cor_t *cor);
+
+/**
+ * @brief Atende a campainha (esvazia a FIFO do Core 1).
+ * @return true se o Core 0 publicou algo desde a última chamada.
+ */
+bool anel_amostras_campainha(void);
+
+/**
+ * @brief Retira a amostra mais antiga do anel (só o Core 1 lê).
+ * @return false se o anel estiver vazio.
+ */
+bool anel_amostras_retirar(amostra_cor_t *amostra);
+
+/**
+ * @brief Amostras descartadas por anel cheio desde o início.
+ */
+uint32_t anel_amostras_perdidas(void);
+
+/**
+ * @brief Pede ao Core 0 que mude o modo (só o Core 1 chama; ex.: WebSocket).
+ * @param modo 0 = Normal (volta ao menu), n = tipo_daltonismo_t n-1 (tela de análise).
+ */
+void pedir_modo_web(int modo);
+
+/**
+ * @brief No Core 0: o modo pedido pela web desde a última chamada, se houver.
+ * @return true se há um pedido novo em *modo.
+ */
+bool modo_web_pedido(int *modo);
+
 // Protótipo da função que será executada no Core 1 (web server)
 void core1_entry(); // Nome da função atualizado para 'core1_entry'
 
@@ -27,4 +90,4 @@ void core1_entry(); // Nome da função atualizado para 'core1_entry'
 }
 #endif
 
-#endif // SHARED_DATA_H
\ No newline at end of file
+#endif // SHARED_DATA_H
@@ -7,23 +7,73 @@
  */
 
 #include "tcs34725.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "i2c_dma_rp2040.h"
 
 // --- Registradores Internos e Comandos ---
 #define TCS34725_COMMAND_BIT 0x80 // Bit que deve ser setado para acessar registradores.
+#define TCS34725_SPECIAL_FN  0x60 // Tipo de comando "função especial".
+#define TCS34725_CLEAR_INT   0x06 // Função especial: limpa a interrupção RGBC.
 
 // Endereços dos Registradores
 #define TCS34725_ENABLE_REG 0x00 // Usado para ligar/desligar o sensor.
 #define TCS34725_ATIME_REG  0x01 // Usado para configurar o tempo de integração do ADC.
+#define TCS34725_PERS_REG   0x0C // Filtro de persistência da interrupção.
 #define TCS34725_CONTROL_REG 0x0F // Usado para configurar o ganho (gain).
 #define TCS34725_ID_REG     0x12 // Contém o ID do chip.
+#define TCS34725_STATUS_REG 0x13 // Contém os bits AVALID e AINT.
 #define TCS34725_CDATAL_REG 0x14 // Registrador inicial dos dados de cor (Clear, low byte).
 
+// Bits do registrador ENABLE
+#define TCS34725_ENABLE_PON  0x01 // Liga o oscilador interno.
+#define TCS34725_ENABLE_AEN  0x02 // Habilita o ADC RGBC.
+#define TCS34725_ENABLE_AIEN 0x10 // Habilita a interrupção RGBC.
+
+// Cada passo de ATIME dura 2.4 ms; cada ciclo tem ainda ~2.4 ms de inicialização.
+#define TCS34725_ATIME_PASSO_US 2400
+// Intervalo entre consultas ao STATUS quando não há pino INT.
+#define TCS34725_INTERVALO_POLLING_US 1000
+
+// --- Estado da aquisição sincronizada ---
+static uint8_t atime_atual = 0xFF;                  // ATIME programado no sensor.
+static int pino_int = TCS34725_SEM_PINO_INT;        // GPIO ligado ao INT (ou nenhum).
+static volatile bool conversao_pronta = false;      // Setado pela IRQ do pino INT.
+static absolute_time_t ultima_conversao;            // Quando a última conversão foi lida.
+
+// Todas as transações passam pelo motor I2C assíncrono: enquanto o DMA move
+// os bytes, o núcleo dorme em vez de girar em i2c_*_blocking.
+static bool tcs34725_transfer(i2c_inst_t* i2c, const uint8_t* escrita, uint16_t num_escrita,
+                              uint8_t* leitura, uint16_t num_leitura) {
+    i2c_dma_transferencia_t t = {
+        .endereco = TCS34725_ADDR,
+        .escrita = escrita,
+        .num_escrita = num_escrita,
+        .leitura = leitura,
+        .num_leitura = num_leitura,
+    };
+    return i2c_dma_transferir(i2c_dma_barramento(i2c), &t) == I2C_DMA_OK;
+}
+
+static bool tcs34725_write_reg(i2c_inst_t* i2c, uint8_t reg, uint8_t val) {
+    uint8_t cmd[] = {TCS34725_COMMAND_BIT | reg, val};
+    return tcs34725_transfer(i2c, cmd, 2, NULL, 0);
+}
+
+static bool tcs34725_read_regs(i2c_inst_t* i2c, uint8_t reg, uint8_t* buffer, size_t len) {
+    uint8_t cmd = TCS34725_COMMAND_BIT | reg;
+    return tcs34725_transfer(i2c, &cmd, 1, buffer, len);
+}
+
+static bool tcs34725_clear_interrupt(i2c_inst_t* i2c) {
+    uint8_t cmd = TCS34725_COMMAND_BIT | TCS34725_SPECIAL_FN | TCS34725_CLEAR_INT;
+    return tcs34725_transfer(i2c, &cmd, 1, NULL, 0);
+}
+
 bool tcs34725_init(i2c_inst_t* i2c, uint8_t atime_val, uint8_t gain_val) { // <<< NOVOS PARÂMETROS
     // 1. Verifica a identidade do chip para garantir que estamos falando com o sensor correto.
-    uint8_t id_reg = TCS34725_COMMAND_BIT | TCS34725_ID_REG;
-    uint8_t chip_id;
-    i2c_write_blocking(i2c, TCS34725_ADDR, &id_reg, 1, false);
-    i2c_read_blocking(i2c, TCS34725_ADDR, &chip_id, 1, false);
+    uint8_t chip_id = 0;
+    tcs34725_read_regs(i2c, TCS34725_ID_REG, &chip_id, 1);
 
     if (chip_id != 0x44 && chip_id != 0x4D) { // ID para TCS34725 e TCS34727
         return false; // ID incorreto, sensor não encontrado ou não é o esperado.
@@ -32,35 +82,168 @@ bool tcs34725_init(i2c_inst_t* i2c, uint8_t atime_val, uint8_t gain_val) { // <<
     // 2. Configura o tempo de integração do ADC.
     // O valor 0xEB resulta em (256 - 235) * 2.4ms = 50.4ms.
     // Use o 'atime_val' passado como parâmetro.
-    uint8_t atime_cmd[] = {TCS34725_COMMAND_BIT | TCS34725_ATIME_REG, atime_val}; // <<< USA PARÂMETRO
-    i2c_write_blocking(i2c, TCS34725_ADDR, atime_cmd, 2, false);
+    tcs34725_write_reg(i2c, TCS34725_ATIME_REG, atime_val); // <<< USA PARÂMETRO
+    atime_atual = atime_val;
 
     // 3. Configura o ganho do amplificador.
     // Use o 'gain_val' passado como parâmetro.
-    uint8_t control_cmd[] = {TCS34725_COMMAND_BIT | TCS34725_CONTROL_REG, gain_val}; // <<< USA PARÂMETRO
-    i2c_write_blocking(i2c, TCS34725_ADDR, control_cmd, 2, false);
-    
+    tcs34725_write_reg(i2c, TCS34725_CONTROL_REG, gain_val); // <<< USA PARÂMETRO
+
     // 4. Liga o oscilador interno (PON) e habilita o ADC (AEN).
-    uint8_t enable_cmd[] = {TCS34725_COMMAND_BIT | TCS34725_ENABLE_REG, 0x03}; // PON=1, AEN=1
-    i2c_write_blocking(i2c, TCS34725_ADDR, enable_cmd, 2, false);
+    tcs34725_write_reg(i2c, TCS34725_ENABLE_REG, TCS34725_ENABLE_PON | TCS34725_ENABLE_AEN);
 
     // Pequena pausa para a primeira conversão após ligar o ADC.
-    sleep_ms(3); 
-    
+    sleep_ms(3);
+    ultima_conversao = get_absolute_time();
+
     return true; // Inicialização bem-sucedida.
 }
 
 void tcs34725_read_colors(i2c_inst_t* i2c, tcs34725_color_data_t* colors) {
-    uint8_t buffer[8];
-    uint8_t start_reg = TCS34725_COMMAND_BIT | TCS34725_CDATAL_REG;
+    uint8_t buffer[8] = {0};
 
     // Pede ao sensor para ler 8 bytes em sequência a partir do registrador CDATAL.
-    i2c_write_blocking(i2c, TCS34725_ADDR, &start_reg, 1, true);
-    i2c_read_blocking(i2c, TCS34725_ADDR, buffer, 8, false);
+    tcs34725_read_regs(i2c, TCS34725_CDATAL_REG, buffer, 8);
 
     // Converte os pares de bytes lidos (little-endian) em valores de 16 bits.
     colors->clear = (buffer[1] << 8) | buffer[0];
     colors->red   = (buffer[3] << 8) | buffer[2];
     colors->green = (buffer[5] << 8) | buffer[4];
     colors->blue  = (buffer[7] << 8) | buffer[6];
-}
\ No newline at end of file
+}
+
+uint32_t tcs34725_integration_time_us(uint8_t atime_val) {
+    return (256u - atime_val) * TCS34725_ATIME_PASSO_US;
+}
+
+bool tcs34725_set_config(i2c_inst_t* i2c, uint8_t atime_val, uint8_t gain_val) {
+    // Desliga o ADC (mantendo o oscilador) para descartar a integração em andamento.
+    if (!tcs34725_write_reg(i2c, TCS34725_ENABLE_REG, TCS34725_ENABLE_PON) ||
+        !tcs34725_write_reg(i2c, TCS34725_ATIME_REG, atime_val) ||
+        !tcs34725_write_reg(i2c, TCS34725_CONTROL_REG, gain_val)) {
+        return false;
+    }
+    atime_atual = atime_val;
+    tcs34725_clear_interrupt(i2c);
+    conversao_pronta = false;
+
+    uint8_t enable = TCS34725_ENABLE_PON | TCS34725_ENABLE_AEN | TCS34725_ENABLE_AIEN;
+    if (!tcs34725_write_reg(i2c, TCS34725_ENABLE_REG, enable)) {
+        return false;
+    }
+    ultima_conversao = get_absolute_time();
+    return true;
+}
+
+// IRQ do pino INT: o sensor puxa o pino para nível baixo ao fim de cada conversão.
+static void tcs34725_int_irq_handler(void) {
+    if (gpio_get_irq_event_mask(pino_int) & GPIO_IRQ_EDGE_FALL) {
+        gpio_acknowledge_irq(pino_int, GPIO_IRQ_EDGE_FALL);
+        conversao_pronta = true;
+    }
+}
+
+bool tcs34725_enable_sync(i2c_inst_t* i2c, int int_pin) {
+    // PERS = 0: toda conversão RGBC gera interrupção, independente dos limiares.
+    if (!tcs34725_write_reg(i2c, TCS34725_PERS_REG, 0x00) ||
+        !tcs34725_write_reg(i2c, TCS34725_ENABLE_REG,
+                            TCS34725_ENABLE_PON | TCS34725_ENABLE_AEN | TCS34725_ENABLE_AIEN)) {
+        return false;
+    }
+    // Descarta a conversão que já estava em andamento/pendente.
+    tcs34725_clear_interrupt(i2c);
+    conversao_pronta = false;
+    ultima_conversao = get_absolute_time();
+
+    pino_int = int_pin;
+    if (pino_int >= 0) {
+        // O INT é open-drain e ativo em nível baixo.
+        gpio_init(pino_int);
+        gpio_set_dir(pino_int, GPIO_IN);
+        gpio_pull_up(pino_int);
+        // Handler "raw" para não substituir o callback GPIO já usado pelos botões.
+        gpio_add_raw_irq_handler(pino_int, tcs34725_int_irq_handler);
+        gpio_set_irq_enabled(pino_int, GPIO_IRQ_EDGE_FALL, true);
+        irq_set_enabled(IO_IRQ_BANK0, true);
+    }
+    return true;
+}
+
+// Lê a conversão que acabou de terminar e libera o sensor para sinalizar a próxima.
+static void tcs34725_read_conversion(i2c_inst_t* i2c, tcs34725_color_data_t* colors) {
+    // A leitura em bloco a partir de CDATAL usa os registradores-sombra do sensor,
+    // então os 4 canais pertencem à mesma conversão.
+    tcs34725_read_colors(i2c, colors);
+    ultima_conversao = get_absolute_time();
+    // Limpa AINT (e libera o pino INT) para que a próxima conversão seja sinalizada.
+    tcs34725_clear_interrupt(i2c);
+}
+
+// AVALID garante que a integração terminou; AINT, que ela ainda não foi lida.
+static bool tcs34725_status_ready(uint8_t status) {
+    return (status & (TCS34725_STATUS_AVALID | TCS34725_STATUS_AINT)) ==
+           (TCS34725_STATUS_AVALID | TCS34725_STATUS_AINT);
+}
+
+bool tcs34725_read_colors_if_ready(i2c_inst_t* i2c, tcs34725_color_data_t* colors) {
+    if (pino_int >= 0) {
+        if (!conversao_pronta) {
+            return false;
+        }
+        conversao_pronta = false;
+    } else {
+        // Antes do fim previsto da conversão, nem consulta o STATUS.
+        uint32_t integracao_us = tcs34725_integration_time_us(atime_atual);
+        if (absolute_time_diff_us(get_absolute_time(), delayed_by_us(ultima_conversao, integracao_us)) > 0) {
+            return false;
+        }
+        uint8_t status = 0;
+        if (!tcs34725_read_regs(i2c, TCS34725_STATUS_REG, &status, 1) || !tcs34725_status_ready(status)) {
+            return false;
+        }
+    }
+    tcs34725_read_conversion(i2c, colors);
+    return true;
+}
+
+bool tcs34725_read_colors_sync(i2c_inst_t* i2c, tcs34725_color_data_t* colors) {
+    uint32_t integracao_us = tcs34725_integration_time_us(atime_atual);
+    // Margem para a fase de inicialização do ciclo (~2.4 ms) e a tolerância do oscilador.
+    uint32_t margem_us = TCS34725_ATIME_PASSO_US + integracao_us / 8;
+
+    // Prazo fixado uma vez, antes de qualquer espera: no pior caso, uma integração mais a margem.
+    absolute_time_t prazo = make_timeout_time_us(integracao_us + margem_us);
+
+    if (pino_int >= 0) {
+        while (!conversao_pronta) {
+            if (best_effort_wfe_or_timeout(prazo)) {
+                return false;
+            }
+        }
+        conversao_pronta = false;
+    } else {
+        // Não adianta consultar o STATUS antes do fim previsto da próxima conversão.
+        absolute_time_t previsao = delayed_by_us(ultima_conversao, integracao_us);
+        int64_t espera_us = absolute_time_diff_us(get_absolute_time(), previsao) - TCS34725_INTERVALO_POLLING_US;
+        if (espera_us > 0) {
+            sleep_us(espera_us);
+        }
+
+        uint8_t status = 0;
+        while (true) {
+            if (!tcs34725_read_regs(i2c, TCS34725_STATUS_REG, &status, 1)) {
+                return false;
+            }
+            if (tcs34725_status_ready(status)) {
+                break;
+            }
+            if (time_reached(prazo)) {
+                return false;
+            }
+            sleep_us(TCS34725_INTERVALO_POLLING_US);
+        }
+    }
+
+    tcs34725_read_conversion(i2c, colors);
+    return true;
+}
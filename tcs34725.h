@@ -14,6 +14,19 @@
 
 #define TCS34725_ADDR 0x29
 
+// Bits do registrador STATUS
+#define TCS34725_STATUS_AVALID 0x01 // Canais RGBC completaram ao menos uma integração.
+#define TCS34725_STATUS_AINT   0x10 // Interrupção RGBC pendente (uma nova conversão terminou).
+
+// Valor de 'int_pin' quando o pino INT do sensor não está ligado a nenhum GPIO.
+#define TCS34725_SEM_PINO_INT (-1)
+
+// Códigos do registrador CONTROL (ganho do amplificador)
+#define TCS34725_GAIN_1X  0x00
+#define TCS34725_GAIN_4X  0x01
+#define TCS34725_GAIN_16X 0x02
+#define TCS34725_GAIN_60X 0x03
+
 // Estrutura para armazenar os 4 canais de cor lidos
 typedef struct {
     uint16_t clear;
@@ -26,4 +39,48 @@ typedef struct {
 bool tcs34725_init(i2c_inst_t* i2c_port, uint8_t atime_val, uint8_t gain_val);
 void tcs34725_read_colors(i2c_inst_t* i2c_port, tcs34725_color_data_t* colors);
 
+/**
+ * @brief Retorna a duração de um ciclo de integração RGBC, em microssegundos.
+ * @param atime_val Valor do registrador ATIME.
+ */
+uint32_t tcs34725_integration_time_us(uint8_t atime_val);
+
+/**
+ * @brief Troca o tempo de integração e o ganho com o sensor em operação.
+ *
+ * Reinicia o ciclo de integração para que a próxima conversão entregue por
+ * tcs34725_read_colors_sync() já use inteiramente a nova configuração.
+ */
+bool tcs34725_set_config(i2c_inst_t* i2c_port, uint8_t atime_val, uint8_t gain_val);
+
+/**
+ * @brief Habilita a aquisição sincronizada com os ciclos de integração.
+ *
+ * Configura o sensor para sinalizar (AINT / pino INT) o fim de cada conversão.
+ * Se 'int_pin' for um GPIO válido, o fim da conversão é detectado por IRQ na
+ * borda de descida do pino INT; com TCS34725_SEM_PINO_INT, o registrador
+ * STATUS é consultado (polling) com prazo.
+ * @return true se a configuração foi aceita pelo sensor.
+ */
+bool tcs34725_enable_sync(i2c_inst_t* i2c_port, int int_pin);
+
+/**
+ * @brief Aguarda a próxima conversão do sensor e lê os 4 canais.
+ *
+ * Cada chamada entrega exatamente uma conversão nova: a mesma conversão nunca
+ * é lida duas vezes. A espera é limitada a um tempo de integração (mais uma
+ * pequena margem de tolerância do oscilador interno).
+ * @return true se uma amostra nova foi lida, false se o prazo expirou.
+ */
+bool tcs34725_read_colors_sync(i2c_inst_t* i2c_port, tcs34725_color_data_t* colors);
+
+/**
+ * @brief Como tcs34725_read_colors_sync(), mas sem esperar.
+ *
+ * Lê a conversão nova se ela já terminou; senão volta na hora. Sem pino INT,
+ * o STATUS só é consultado depois do fim previsto da conversão.
+ * @return true se uma amostra nova foi lida.
+ */
+bool tcs34725_read_colors_if_ready(i2c_inst_t* i2c_port, tcs34725_color_data_t* colors);
+
 #endif
\ No newline at end of file
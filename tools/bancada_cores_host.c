@@ -0,0 +1,90 @@
+// bancada_cores_host.c
+// Compara, no PC, a busca na árvore k-d com a varredura linear da base.
+// Compilado e executado por tools/bancada_cores_host.sh para vários tamanhos de base.
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "arvore_cores.h"
+#include "tabelas_cores.h"
+
+#define CONSULTAS 200000
+#define K_VIZINHOS 5
+
+static uint8_t consultas[CONSULTAS][3];
+
+static uint16_t linear_mais_proxima(uint8_t r, uint8_t g, uint8_t b)
+{
+    uint32_t menor = UINT32_MAX;
+    uint16_t melhor = 0;
+    for (uint16_t i = 0; i < TABELAS_CORES_NUM_CORES; i++)
+    {
+        int32_t dr = (int32_t)r - cores_rgb_sensor[i][0];
+        int32_t dg = (int32_t)g - cores_rgb_sensor[i][1];
+        int32_t db = (int32_t)b - cores_rgb_sensor[i][2];
+        uint32_t d = (uint32_t)(dr * dr + dg * dg + db * db);
+        if (d < menor)
+        {
+            menor = d;
+            melhor = i;
+        }
+    }
+    return melhor;
+}
+
+static double agora_ns(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+int main(void)
+{
+    srand(12345);
+    for (int i = 0; i < CONSULTAS; i++)
+    {
+        for (int e = 0; e < 3; e++)
+        {
+            consultas[i][e] = (uint8_t)(rand() & 0xFF);
+        }
+    }
+
+    volatile uint32_t sumidouro = 0;
+    double t0 = agora_ns();
+    for (int i = 0; i < CONSULTAS; i++)
+    {
+        sumidouro += linear_mais_proxima(consultas[i][0], consultas[i][1], consultas[i][2]);
+    }
+    double t1 = agora_ns();
+    for (int i = 0; i < CONSULTAS; i++)
+    {
+        sumidouro += arvore_cores_mais_proxima(&arvore_cores, consultas[i][0], consultas[i][1], consultas[i][2]);
+    }
+    double t2 = agora_ns();
+    vizinho_cor_t vizinhos[K_VIZINHOS];
+    for (int i = 0; i < CONSULTAS; i++)
+    {
+        arvore_cores_k_mais_proximas(&arvore_cores, consultas[i][0], consultas[i][1], consultas[i][2],
+                                     vizinhos, K_VIZINHOS);
+        sumidouro += vizinhos[0].indice;
+    }
+    double t3 = agora_ns();
+
+    // A árvore tem de devolver exatamente a mesma cor que a varredura.
+    int divergencias = 0;
+    for (int i = 0; i < CONSULTAS; i++)
+    {
+        if (linear_mais_proxima(consultas[i][0], consultas[i][1], consultas[i][2]) !=
+            arvore_cores_mais_proxima(&arvore_cores, consultas[i][0], consultas[i][1], consultas[i][2]))
+        {
+            divergencias++;
+        }
+    }
+
+    printf("%5d cores: linear %8.1f ns  arvore %7.1f ns  arvore k=%d %7.1f ns  divergencias %d\n",
+           TABELAS_CORES_NUM_CORES, (t1 - t0) / CONSULTAS, (t2 - t1) / CONSULTAS, K_VIZINHOS,
+           (t3 - t2) / CONSULTAS, divergencias);
+    return divergencias != 0;
+}
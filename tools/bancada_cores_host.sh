@@ -0,0 +1,23 @@
+#!/bin/sh
+# Bancada da identificação de cor no PC: árvore k-d x varredura linear.
+# Uso: tools/bancada_cores_host.sh [tamanhos...]   (padrão: base real, 500 e 5000 cores)
+set -e
+
+raiz=$(cd "$(dirname "$0")/.." && pwd)
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+cc=${CC:-cc}
+tamanhos=${*:-"base 500 5000"}
+
+for n in $tamanhos; do
+    if [ "$n" = base ]; then
+        origem="--paleta $raiz/paleta_cores.csv"
+    else
+        origem="--aleatorias $n"
+    fi
+    python3 "$raiz/tools/gerar_tabelas_cores.py" $origem --motor kdtree --saida "$tmp/$n" >/dev/null
+    $cc -O2 -I"$raiz" -I"$tmp/$n" -o "$tmp/$n/bancada" \
+        "$raiz/tools/bancada_cores_host.c" "$raiz/arvore_cores.c" "$tmp/$n/tabelas_cores.c"
+    "$tmp/$n/bancada"
+done
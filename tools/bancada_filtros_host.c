@@ -0,0 +1,84 @@
+// bancada_filtros_host.c
+// Mede, no PC, os filtros de daltonismo em lote (RGB888 e RGB565) contra uma
+// chamada de aplicar_filtro_daltonismo() por pixel, em megapixels por segundo.
+// Compilado e executado por tools/bancada_filtros_host.sh para cada motor.
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "filtros_daltonismo.h"
+
+#define PIXELS (320 * 240)
+#define REPETICOES 40
+
+static uint8_t rgb888[PIXELS * 3];
+static uint8_t saida888[PIXELS * 3];
+static uint16_t rgb565[PIXELS];
+static uint16_t saida565[PIXELS];
+
+static double agora_ns(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+static double megapixels_por_segundo(double ns)
+{
+    return (double)PIXELS * REPETICOES / ns * 1e3;
+}
+
+int main(void)
+{
+    srand(12345);
+    for (int i = 0; i < PIXELS * 3; i++)
+    {
+        rgb888[i] = (uint8_t)(rand() & 0xFF);
+    }
+    for (int i = 0; i < PIXELS; i++)
+    {
+        rgb565[i] = (uint16_t)(rand() & 0xFFFF);
+    }
+
+    double t0 = agora_ns();
+    for (int k = 0; k < REPETICOES; k++)
+    {
+        for (int i = 0; i < PIXELS; i++)
+        {
+            uint8_t r = rgb888[3 * i], g = rgb888[3 * i + 1], b = rgb888[3 * i + 2];
+            aplicar_filtro_daltonismo(DALTONISMO_PROTANOPIA, DALTONISMO_SEVERIDADE_MAX, &r, &g, &b);
+            saida888[3 * i] = r;
+            saida888[3 * i + 1] = g;
+            saida888[3 * i + 2] = b;
+        }
+    }
+    double t1 = agora_ns();
+    for (int k = 0; k < REPETICOES; k++)
+    {
+        filtrar_daltonismo_rgb888(DALTONISMO_PROTANOPIA, DALTONISMO_SEVERIDADE_MAX, rgb888, saida888, PIXELS);
+    }
+    double t2 = agora_ns();
+    for (int k = 0; k < REPETICOES; k++)
+    {
+        filtrar_daltonismo_rgb565(DALTONISMO_PROTANOPIA, DALTONISMO_SEVERIDADE_MAX, rgb565, saida565, PIXELS);
+    }
+    double t3 = agora_ns();
+
+    // O lote tem de dar exatamente o mesmo resultado que o filtro pixel a pixel.
+    int divergencias = 0;
+    for (int i = 0; i < PIXELS; i++)
+    {
+        uint8_t r = rgb888[3 * i], g = rgb888[3 * i + 1], b = rgb888[3 * i + 2];
+        aplicar_filtro_daltonismo(DALTONISMO_PROTANOPIA, DALTONISMO_SEVERIDADE_MAX, &r, &g, &b);
+        if (r != saida888[3 * i] || g != saida888[3 * i + 1] || b != saida888[3 * i + 2])
+        {
+            divergencias++;
+        }
+    }
+
+    printf("por pixel %6.1f Mpix/s  lote RGB888 %6.1f Mpix/s  lote RGB565 %6.1f Mpix/s  divergencias %d\n",
+           megapixels_por_segundo(t1 - t0), megapixels_por_segundo(t2 - t1), megapixels_por_segundo(t3 - t2),
+           divergencias);
+    return divergencias != 0;
+}
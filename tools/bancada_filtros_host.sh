@@ -0,0 +1,19 @@
+#!/bin/sh
+# Bancada dos filtros de daltonismo em lote no PC, em megapixels por segundo.
+# Uso: tools/bancada_filtros_host.sh [motores...]   (padrão: matriz lut17)
+set -e
+
+raiz=$(cd "$(dirname "$0")/.." && pwd)
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+cc=${CC:-cc}
+motores=${*:-"matriz lut17"}
+
+for motor in $motores; do
+    python3 "$raiz/tools/gerar_tabelas_filtros.py" --motor "$motor" --saida "$tmp/$motor" >/dev/null
+    $cc -O2 -I"$raiz" -I"$tmp/$motor" -o "$tmp/$motor/bancada" \
+        "$raiz/tools/bancada_filtros_host.c" "$raiz/filtros_daltonismo.c" "$tmp/$motor/tabelas_filtros.c"
+    echo "--- motor $motor ---"
+    "$tmp/$motor/bancada"
+done
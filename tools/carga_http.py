@@ -0,0 +1,157 @@
+#!/usr/bin/env python3
+"""Teste de carga do servidor HTTP do aparelho com vários clientes simultâneos.
+
+Abre N clientes em paralelo (um por thread), cada um repetindo GET /api/cor numa
+conexão nova por pedido ou, com --manter, sempre na mesma conexão (keep-alive).
+A cada segundo mostra a vazão total, os erros e as latências p50/p99 daquele
+segundo; no fim, o resumo da rodada inteira.
+
+Só usa a biblioteca padrão.
+
+Uso: tools/carga_http.py [--host 192.168.4.1] [--clientes 8] [--duracao 30] [--caminho /api/cor] [--manter]
+Sai com código 1 se algum pedido falhar.
+
+Ainda não há medição no aparelho registrada: a ferramenta só foi conferida contra
+um servidor local. Ao medir, rode com 8 clientes ou mais, com e sem --manter, e
+anote a vazão, os erros e o p99 de cada rodada.
+"""
+
+import argparse
+import socket
+import sys
+import threading
+import time
+
+
+def percentil(valores, p):
+    if not valores:
+        return float("nan")
+    ordenados = sorted(valores)
+    return ordenados[min(len(ordenados) - 1, int(p / 100.0 * len(ordenados)))]
+
+
+def ler_resposta(sock):
+    """Lê uma resposta inteira (uma por vez, sem pipelining) e confere o status."""
+    dados = b""
+    while b"\r\n\r\n" not in dados:
+        parte = sock.recv(4096)
+        if not parte:
+            raise ConnectionError("conexão encerrada antes dos cabeçalhos")
+        dados += parte
+    cabecalhos, _, dados = dados.partition(b"\r\n\r\n")
+    linha = cabecalhos.split(b"\r\n", 1)[0]
+    tamanho = None
+    for campo in cabecalhos.split(b"\r\n")[1:]:
+        nome, _, valor = campo.partition(b":")
+        if nome.strip().lower() == b"content-length":
+            tamanho = int(valor)
+    if tamanho is None:
+        raise ConnectionError("resposta sem Content-Length: %r" % linha)
+    while len(dados) < tamanho:
+        parte = sock.recv(4096)
+        if not parte:
+            raise ConnectionError("corpo truncado: %d de %d bytes" % (len(dados), tamanho))
+        dados += parte
+    if b" 200 " not in linha:
+        raise ConnectionError("resposta inesperada: %r" % linha)
+
+
+def pedir(sock, host, caminho, manter):
+    """Faz um GET na conexão e devolve a latência em ms; levanta exceção em qualquer falha."""
+    t0 = time.perf_counter()
+    sock.sendall(("GET %s HTTP/1.1\r\nHost: %s\r\nConnection: %s\r\n\r\n"
+                  % (caminho, host, "keep-alive" if manter else "close")).encode())
+    ler_resposta(sock)
+    return (time.perf_counter() - t0) * 1000.0
+
+
+class Placar:
+    """Contagens do segundo corrente e da rodada, compartilhadas pelas threads."""
+
+    def __init__(self):
+        self.trava = threading.Lock()
+        self.latencias = []
+        self.erros = 0
+        self.total_latencias = []
+        self.total_erros = 0
+
+    def sucesso(self, latencia):
+        with self.trava:
+            self.latencias.append(latencia)
+            self.total_latencias.append(latencia)
+
+    def falha(self):
+        with self.trava:
+            self.erros += 1
+            self.total_erros += 1
+
+    def fechar_segundo(self):
+        with self.trava:
+            latencias, erros = self.latencias, self.erros
+            self.latencias, self.erros = [], 0
+        return latencias, erros
+
+
+def cliente(args, placar, fim):
+    sock = None
+    while time.monotonic() < fim:
+        try:
+            if sock is None:
+                sock = socket.create_connection((args.host, args.porta), timeout=args.prazo)
+            placar.sucesso(pedir(sock, args.host, args.caminho, args.manter))
+            if not args.manter:
+                sock.close()
+                sock = None
+        except (OSError, ValueError) as erro:
+            placar.falha()
+            if args.verboso:
+                print("erro: %s" % erro, file=sys.stderr)
+            if sock is not None:
+                sock.close()
+                sock = None
+    if sock is not None:
+        sock.close()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--host", default="192.168.4.1")
+    parser.add_argument("--porta", type=int, default=80)
+    parser.add_argument("--caminho", default="/api/cor")
+    parser.add_argument("--clientes", type=int, default=8)
+    parser.add_argument("--duracao", type=float, default=30.0, help="segundos")
+    parser.add_argument("--prazo", type=float, default=5.0, help="timeout de cada pedido, em segundos")
+    parser.add_argument("--manter", action="store_true",
+                        help="reusa a conexão (keep-alive) em vez de abrir uma por pedido")
+    parser.add_argument("--verboso", action="store_true", help="mostra cada erro")
+    args = parser.parse_args()
+
+    placar = Placar()
+    inicio = time.monotonic()
+    fim = inicio + args.duracao
+    threads = [threading.Thread(target=cliente, args=(args, placar, fim), daemon=True)
+               for _ in range(args.clientes)]
+    for t in threads:
+        t.start()
+
+    print("%d clientes em GET %s por %.0f s, %s" % (args.clientes, args.caminho, args.duracao,
+                                                   "keep-alive" if args.manter else "uma conexão por pedido"))
+    print("   t  pedidos/s  erros   p50 ms   p99 ms")
+    segundo = 0
+    while any(t.is_alive() for t in threads):
+        segundo += 1
+        time.sleep(max(0.0, inicio + segundo - time.monotonic()))
+        latencias, erros = placar.fechar_segundo()
+        print("%4d  %9d  %5d  %7.1f  %7.1f"
+              % (segundo, len(latencias), erros, percentil(latencias, 50), percentil(latencias, 99)))
+
+    decorrido = time.monotonic() - inicio
+    total = placar.total_latencias
+    print("total: %d pedidos (%.1f/s), %d erros, p50 %.1f ms, p99 %.1f ms"
+          % (len(total), len(total) / decorrido, placar.total_erros,
+             percentil(total, 50), percentil(total, 99)))
+    return 1 if placar.total_erros else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,185 @@
+#!/usr/bin/env python3
+"""Gera a tabela dos arquivos da página web (HTML, JS, CSS...), comprimidos com gzip.
+
+Escreve ativos_web.h / ativos_web.c no diretório de saída (executado pelo
+CMake). Cada arquivo do diretório de entrada vira um vetor const, em flash,
+com o conteúdo já comprimido. A tabela também traz, prontos, os cabeçalhos da
+resposta: Content-Length, Content-Type, Content-Encoding, ETag e
+Cache-Control. O servidor copia os cabeçalhos e envia o corpo direto da flash,
+sem cópia.
+
+  * gzip com mtime 0 e nível 9: o mesmo arquivo dá sempre os mesmos bytes,
+    e o ETag (SHA-1 do que é enviado) só muda quando o conteúdo muda.
+  * Arquivos que o gzip não diminui (imagens já comprimidas) vão como estão,
+    sem Content-Encoding.
+  * Dos comprimidos fica também uma cópia sem compressão (sem_gzip), com ETag
+    próprio, para clientes sem "gzip" no Accept-Encoding. A página inteira tem
+    poucos KB: a cópia custa pouco em flash.
+"""
+
+import argparse
+import gzip
+import hashlib
+import os
+import sys
+
+TIPOS = {
+    ".html": "text/html; charset=utf-8",
+    ".js": "text/javascript; charset=utf-8",
+    ".css": "text/css; charset=utf-8",
+    ".json": "application/json",
+    ".svg": "image/svg+xml",
+    ".png": "image/png",
+    ".ico": "image/x-icon",
+    ".txt": "text/plain; charset=utf-8",
+}
+
+# A página muda a cada firmware, mas quem a tem em cache revalida pelo ETag (304).
+CACHE_CONTROL = "no-cache"
+
+
+def escrever_se_mudou(caminho, conteudo):
+    # Não reescreve arquivos iguais, para não forçar recompilações.
+    if os.path.exists(caminho):
+        with open(caminho, encoding="utf-8") as f:
+            if f.read() == conteudo:
+                return
+    with open(caminho, "w", encoding="utf-8") as f:
+        f.write(conteudo)
+
+
+def formatar_bytes(dados, por_linha=16):
+    linhas = []
+    for i in range(0, len(dados), por_linha):
+        linhas.append("    " + ", ".join("0x%02x" % b for b in dados[i:i + por_linha]) + ",")
+    return "\n".join(linhas)
+
+
+def ler_ativos(entrada):
+    ativos = []
+    for raiz, diretorios, arquivos in os.walk(entrada):
+        diretorios.sort()
+        for nome in sorted(arquivos):
+            if nome.startswith("."):
+                continue
+            completo = os.path.join(raiz, nome)
+            relativo = os.path.relpath(completo, entrada).replace(os.sep, "/")
+            extensao = os.path.splitext(nome)[1].lower()
+            if extensao not in TIPOS:
+                sys.exit("Tipo de arquivo sem Content-Type conhecido: %s" % relativo)
+            if any(c in relativo for c in '"\\?% '):
+                sys.exit("Nome de arquivo que não serve de caminho HTTP: %s" % relativo)
+            with open(completo, "rb") as f:
+                original = f.read()
+            comprimido = gzip.compress(original, compresslevel=9, mtime=0)
+            usar_gzip = len(comprimido) < len(original)
+            ativos.append({
+                "caminho": "/" + relativo,
+                "tipo": TIPOS[extensao],
+                "dados": comprimido if usar_gzip else original,
+                "sem_gzip": original if usar_gzip else None,
+                "original": len(original),
+                "gzip": usar_gzip,
+            })
+    if not ativos:
+        sys.exit("Nenhum arquivo em %s" % entrada)
+    return ativos
+
+
+def cabecalhos_c(ativo, dados, usar_gzip):
+    """Cabeçalhos da resposta e ETag (SHA-1 do corpo enviado), já escapados para C."""
+    etag = '"%s"' % hashlib.sha1(dados).hexdigest()[:16]
+    cabecalhos = "Content-Length: %d\\r\\nContent-Type: %s\\r\\n" % (len(dados), ativo["tipo"])
+    if usar_gzip:
+        cabecalhos += "Content-Encoding: gzip\\r\\n"
+    if ativo["sem_gzip"] is not None:
+        cabecalhos += "Vary: Accept-Encoding\\r\\n"
+    cabecalhos += "ETag: %s\\r\\nCache-Control: %s\\r\\n" % (etag.replace('"', '\\"'), CACHE_CONTROL)
+    return cabecalhos, etag.replace('"', '\\"')
+
+
+def entrada_c(ativo, nome, dados, usar_gzip):
+    return """
+// %s%s: %d bytes, %d no corpo
+static const uint8_t %s[%d] = {
+%s
+};
+""" % (ativo["caminho"], "" if usar_gzip or ativo["sem_gzip"] is None else " (sem gzip)", ativo["original"],
+       len(dados), nome, len(dados), formatar_bytes(dados))
+
+
+def valor_entrada(ativo, nome, dados, usar_gzip, sem_gzip):
+    cabecalhos, etag = cabecalhos_c(ativo, dados, usar_gzip)
+    return '{"%s", "%s", "%s", %s, %d, %s, %s}' % (ativo["caminho"], cabecalhos, etag, nome, len(dados),
+                                                  "true" if usar_gzip else "false", sem_gzip)
+
+
+def gerar(ativos, saida):
+    h = """// Gerado por tools/gerar_ativos_web.py. Não edite.
+#ifndef ATIVOS_WEB_H
+#define ATIVOS_WEB_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct ativo_web {
+    const char *caminho;     // "/app.js"
+    const char *cabecalhos;  // Linhas de cabeçalho prontas, cada uma com "\\r\\n"
+    const char *etag;        // Com as aspas, para comparar com If-None-Match
+    const uint8_t *dados;    // Corpo como é enviado, em flash
+    uint32_t tamanho;
+    bool gzip;               // Corpo com Content-Encoding: gzip
+    const struct ativo_web *sem_gzip; // Com 'gzip': o mesmo arquivo sem compressão
+} ativo_web_t;
+
+#define ATIVOS_WEB_QUANTIDADE %d
+
+extern const ativo_web_t ativos_web[ATIVOS_WEB_QUANTIDADE];
+
+#endif // ATIVOS_WEB_H
+""" % len(ativos)
+
+    c = """// Gerado por tools/gerar_ativos_web.py. Não edite.
+#include "ativos_web.h"
+
+#include <stddef.h>
+"""
+    entradas = []
+    total_original = 0
+    total = 0
+    for i, ativo in enumerate(ativos):
+        sem_gzip = "NULL"
+        if ativo["gzip"]:
+            c += entrada_c(ativo, "ativo_%d_sem_gzip" % i, ativo["sem_gzip"], False)
+            c += "\nstatic const ativo_web_t ativo_%d_sem_gzip_web = %s;\n" % (
+                i, valor_entrada(ativo, "ativo_%d_sem_gzip" % i, ativo["sem_gzip"], False, "NULL"))
+            sem_gzip = "&ativo_%d_sem_gzip_web" % i
+            total += len(ativo["sem_gzip"])
+        dados = ativo["dados"]
+        c += entrada_c(ativo, "ativo_%d" % i, dados, ativo["gzip"])
+        entradas.append("    %s," % valor_entrada(ativo, "ativo_%d" % i, dados, ativo["gzip"], sem_gzip))
+        total_original += ativo["original"]
+        total += len(dados)
+
+    c += """
+const ativo_web_t ativos_web[ATIVOS_WEB_QUANTIDADE] = {
+%s
+};
+""" % "\n".join(entradas)
+
+    os.makedirs(saida, exist_ok=True)
+    escrever_se_mudou(os.path.join(saida, "ativos_web.h"), h)
+    escrever_se_mudou(os.path.join(saida, "ativos_web.c"), c)
+    print("Ativos web: %d arquivos, %d bytes em flash com as cópias sem gzip (%d sem compressão)" % (len(ativos), total, total_original))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--entrada", required=True, help="diretório com os arquivos da página")
+    parser.add_argument("--saida", required=True, help="diretório dos arquivos gerados")
+    args = parser.parse_args()
+    gerar(ler_ativos(args.entrada), args.saida)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,468 @@
+#!/usr/bin/env python3
+"""Gera as tabelas de identificação de cor a partir da base de cores.
+
+Lê a paleta (paleta_cores.csv, ou um .json com a mesma informação) e escreve
+tabelas_cores.h / tabelas_cores.c no diretório de saída (executado pelo CMake
+a cada mudança na paleta). As tabelas ficam em flash como dados const.
+
+Tabelas geradas:
+  * Paleta em estrutura de vetores (SoA): RGB lido pelo sensor e RGB ideal
+    empacotados, um bloco único com todos os nomes e o deslocamento de cada
+    nome, e um hash do conteúdo (FNV-1a de 32 bits).
+  * LUT 3D quantizada: para cada célula de 8x8x8 valores RGB (32x32x32
+    células), o índice da cor mais próxima do centro da célula.
+  * Conjuntos de candidatas: para cada célula, as cores que podem estar entre
+    as LUT_VIZINHOS mais próximas de algum ponto da célula. Dão a busca exata
+    das k mais próximas (k <= LUT_VIZINHOS) e o refinamento da mais próxima.
+  * Árvore k-d implícita (sempre gerada): as cores reordenadas de modo que o
+    nó de cada intervalo seja o elemento do meio, com o eixo de corte do nó.
+    Usada nas buscas de k vizinhos e como motor de identificação em bases
+    grandes, onde a LUT deixa de valer a pena (--motor kdtree).
+  * CIELAB (sempre gerado): o Lab de cada cor da base e as tabelas da
+    conversão em ponto fixo de cor_lab.c (sRGB -> linear e raiz cúbica),
+    usados pelo motor perceptivo (--motor lab).
+"""
+
+import argparse
+import csv
+import json
+import os
+import random
+import re
+import sys
+
+LUT_BITS = 5
+LUT_LADO = 1 << LUT_BITS
+LUT_PASSO = 256 // LUT_LADO
+# Deve bater com IDENTIFICACAO_MAX_CANDIDATAS (identificador_cor.h).
+LUT_VIZINHOS = 4
+
+# Devem bater com cor_lab.h / cor_lab.c.
+LAB_ESCALA = 64          # L, a, b em 1/64 de unidade
+LAB_LINEAR_BITS = 15     # sRGB linear e t = X/Xn em Q15
+LAB_RAIZ_PASSO_BITS = 5  # Raiz cúbica tabelada a cada 32 passos de Q15, com interpolação
+
+# sRGB (D65) -> XYZ, com cada linha já dividida pelo branco de referência.
+_BRANCO_D65 = (0.95047, 1.0, 1.08883)
+_SRGB_XYZ = (
+    (0.4124564, 0.3575761, 0.1804375),
+    (0.2126729, 0.7151522, 0.0721750),
+    (0.0193339, 0.1191920, 0.9503041),
+)
+
+CAMPOS = ("nome", "r", "g", "b", "r_ideal", "g_ideal", "b_ideal")
+
+
+def _cor(caminho, onde, registro):
+    try:
+        nome = str(registro["nome"]).strip()
+        valores = [int(registro[campo]) for campo in CAMPOS[1:]]
+    except (KeyError, TypeError, ValueError):
+        sys.exit(f"{caminho}:{onde}: esperado {', '.join(CAMPOS)}")
+    if not nome:
+        sys.exit(f"{caminho}:{onde}: nome vazio")
+    # Os nomes vão direto para o OLED e para o JSON da API, sem escape.
+    if any(ch in nome for ch in '"\\') or any(ord(ch) < 32 for ch in nome):
+        sys.exit(f"{caminho}:{onde}: nome com aspas, barra invertida ou caractere de controle")
+    if any(v < 0 or v > 255 for v in valores):
+        sys.exit(f"{caminho}:{onde}: valor fora de 0-255 em '{nome}'")
+    return (nome, tuple(valores[:3]), tuple(valores[3:]))
+
+
+def ler_paleta(caminho):
+    """Devolve [(nome, (r, g, b), (r_ideal, g_ideal, b_ideal))] na ordem do arquivo.
+
+    CSV: cabeçalho com os nomes de CAMPOS; linhas vazias e linhas começando com
+    '#' são ignoradas. JSON: lista de objetos com os mesmos campos.
+    """
+    with open(caminho, encoding="utf-8") as f:
+        if caminho.endswith(".json"):
+            cores = [_cor(caminho, f"[{i}]", r) for i, r in enumerate(json.load(f))]
+        else:
+            linhas = [(n, l) for n, l in enumerate(f, 1) if l.strip() and not l.lstrip().startswith("#")]
+            leitor = csv.DictReader(l for _, l in linhas)
+            cores = [_cor(caminho, linhas[i + 1][0], r) for i, r in enumerate(leitor)]
+    if not cores:
+        sys.exit(f"{caminho}: paleta vazia")
+    nomes = [c[0] for c in cores]
+    repetidos = sorted({n for n in nomes if nomes.count(n) > 1})
+    if repetidos:
+        sys.exit(f"{caminho}: nomes repetidos: {', '.join(repetidos)}")
+    return cores
+
+
+def base_aleatoria(quantidade, semente):
+    """Base sintética para a bancada no host (tools/bancada_cores_host.sh)."""
+    gerador = random.Random(semente)
+    cores = []
+    for i in range(quantidade):
+        rgb = tuple(gerador.randrange(256) for _ in range(3))
+        cores.append((f"cor {i}", rgb, rgb))
+    return cores
+
+
+def distancia2(a, b):
+    return sum((x - y) * (x - y) for x, y in zip(a, b))
+
+
+def gerar_lut(cores):
+    """Devolve (indice[], conjunto[], conjuntos) para as 32^3 células.
+
+    conjunto[c] é 0 quando uma só cor serve para a célula inteira (base com uma
+    cor), ou 1 + o número do conjunto de candidatas em 'conjuntos'.
+    """
+    pontos = [c[1] for c in cores]
+    indice = []
+    conjunto = []
+    conjuntos = []
+    numero_conjunto = {}
+
+    for ci in range(LUT_LADO):
+        for cj in range(LUT_LADO):
+            for ck in range(LUT_LADO):
+                lo = (ci * LUT_PASSO, cj * LUT_PASSO, ck * LUT_PASSO)
+                hi = tuple(v + LUT_PASSO - 1 for v in lo)
+                centro = tuple(v + (LUT_PASSO - 1) / 2 for v in lo)
+
+                # Mesmo critério do código C: menor distância, empate fica com a primeira.
+                melhor = min(range(len(pontos)), key=lambda i: (distancia2(pontos[i], centro), i))
+                indice.append(melhor)
+
+                # Uma cor só pode estar entre as LUT_VIZINHOS mais próximas de algum ponto
+                # da célula se a menor distância dela até a célula não passar da
+                # LUT_VIZINHOS-ésima menor distância máxima: senão, há LUT_VIZINHOS cores
+                # mais perto dela em todos os pontos.
+                d_min = []
+                d_max = []
+                for p in pontos:
+                    dmin = dmax = 0
+                    for eixo in range(3):
+                        if p[eixo] < lo[eixo]:
+                            dmin += (lo[eixo] - p[eixo]) ** 2
+                        elif p[eixo] > hi[eixo]:
+                            dmin += (p[eixo] - hi[eixo]) ** 2
+                        dmax += max(abs(p[eixo] - lo[eixo]), abs(p[eixo] - hi[eixo])) ** 2
+                    d_min.append(dmin)
+                    d_max.append(dmax)
+                limite = sorted(d_max)[min(LUT_VIZINHOS, len(d_max)) - 1]
+                candidatas = tuple(i for i, d in enumerate(d_min) if d <= limite)
+
+                if len(candidatas) == 1:
+                    conjunto.append(0)
+                    continue
+                if candidatas not in numero_conjunto:
+                    numero_conjunto[candidatas] = len(conjuntos)
+                    conjuntos.append(candidatas)
+                conjunto.append(numero_conjunto[candidatas] + 1)
+
+    return indice, conjunto, conjuntos
+
+
+def gerar_arvore(cores):
+    """Devolve (ordem, eixo): a posição na base e o eixo de corte de cada nó.
+
+    O nó do intervalo [ini, fim) é o elemento (ini + fim) // 2, a mesma conta
+    feita pela busca em arvore_cores.c. O eixo é o de maior amplitude no
+    intervalo, o que poda melhor que alternar R, G, B em bases irregulares.
+    """
+    pontos = [c[1] for c in cores]
+    ordem = list(range(len(pontos)))
+    eixo = [0] * len(pontos)
+
+    pendentes = [(0, len(pontos))]
+    while pendentes:
+        ini, fim = pendentes.pop()
+        if ini >= fim:
+            continue
+        trecho = ordem[ini:fim]
+        amplitudes = [max(pontos[i][e] for i in trecho) - min(pontos[i][e] for i in trecho) for e in range(3)]
+        e = amplitudes.index(max(amplitudes))
+        trecho.sort(key=lambda i: (pontos[i][e], i))
+        ordem[ini:fim] = trecho
+        meio = (ini + fim) // 2
+        eixo[meio] = e
+        pendentes.append((ini, meio))
+        pendentes.append((meio + 1, fim))
+
+    return ordem, eixo
+
+
+def srgb_para_linear(c):
+    c /= 255.0
+    return c / 12.92 if c <= 0.04045 else ((c + 0.055) / 1.055) ** 2.4
+
+
+def lab_f(t):
+    delta = 6.0 / 29.0
+    return t ** (1.0 / 3.0) if t > delta ** 3 else t / (3 * delta * delta) + 4.0 / 29.0
+
+
+def rgb_para_lab(rgb):
+    """Referência exata (em float) da conversão feita por cor_lab_de_rgb()."""
+    linear = [srgb_para_linear(c) for c in rgb]
+    f = [lab_f(sum(m * v for m, v in zip(linha, linear)) / branco)
+         for linha, branco in zip(_SRGB_XYZ, _BRANCO_D65)]
+    return (116 * f[1] - 16, 500 * (f[0] - f[1]), 200 * (f[1] - f[2]))
+
+
+def gerar_tabelas_lab():
+    """Devolve (linear[256], matriz[3][3], raiz[]) no formato de cor_lab.c."""
+    um = 1 << LAB_LINEAR_BITS
+    linear = [round(srgb_para_linear(c) * um) for c in range(256)]
+    matriz = [[round(m / branco * (1 << 14)) for m in linha] for linha, branco in zip(_SRGB_XYZ, _BRANCO_D65)]
+    passo = 1 << LAB_RAIZ_PASSO_BITS
+    # Uma entrada além de t = 1 para a interpolação e para o arredondamento da matriz.
+    raiz = [round(lab_f(i * passo / um) * um) for i in range(um // passo + 2)]
+    return linear, matriz, raiz
+
+
+def hash_paleta(cores):
+    """FNV-1a de 32 bits sobre nome, RGB do sensor e RGB ideal de cada cor, em ordem."""
+    h = 0x811C9DC5
+    for nome, rgb, ideal in cores:
+        for byte in nome.encode("utf-8") + b"\0" + bytes(rgb) + bytes(ideal):
+            h = ((h ^ byte) * 0x01000193) & 0xFFFFFFFF
+    return h
+
+
+def literal_c(texto):
+    saida = []
+    for byte in texto.encode("utf-8"):
+        ch = chr(byte)
+        if ch in '"\\':
+            saida.append("\\" + ch)
+        elif 32 <= byte < 127:
+            saida.append(ch)
+        else:
+            saida.append("\\%03o" % byte)
+    return '"' + "".join(saida) + '\\0"'
+
+
+def formatar_vetor(valores, por_linha=16):
+    linhas = []
+    for i in range(0, len(valores), por_linha):
+        linhas.append("    " + ", ".join(str(v) for v in valores[i:i + por_linha]) + ",")
+    return "\n".join(linhas)
+
+
+def escrever_se_mudou(caminho, conteudo):
+    # Não reescreve arquivos iguais, para não forçar recompilações.
+    if os.path.exists(caminho):
+        with open(caminho, encoding="utf-8") as f:
+            if f.read() == conteudo:
+                return
+    with open(caminho, "w", encoding="utf-8") as f:
+        f.write(conteudo)
+
+
+def gerar(cores, saida, motor):
+    if len(cores) > 65535:
+        sys.exit("A árvore guarda índices de 16 bits: no máximo 65535 cores")
+
+    deslocamentos = []
+    tamanho_nomes = 0
+    for nome, _, _ in cores:
+        deslocamentos.append(tamanho_nomes)
+        tamanho_nomes += len(nome.encode("utf-8")) + 1
+    if tamanho_nomes > 65535:
+        sys.exit("Os deslocamentos dos nomes são de 16 bits: no máximo 64 KiB de nomes")
+    sensor = ",\n".join("    {%d, %d, %d}" % c[1] for c in cores)
+    ideal = ",\n".join("    {%d, %d, %d}" % c[2] for c in cores)
+    nomes = "\n".join("    " + literal_c(c[0]) for c in cores)
+
+    ordem, eixo = gerar_arvore(cores)
+    pontos = ",\n".join("    {%d, %d, %d}" % cores[i][1] for i in ordem)
+
+    lab = ",\n".join("    {%d, %d, %d}" % tuple(round(v * LAB_ESCALA) for v in rgb_para_lab(c[1]))
+                      for c in cores)
+    lab_linear, lab_matriz, lab_raiz = gerar_tabelas_lab()
+    matriz = ",\n".join("    {" + ", ".join(str(v) for v in linha) + "}" for linha in lab_matriz)
+
+    h = f"""// Gerado por tools/gerar_tabelas_cores.py. NÃO EDITE.
+#ifndef TABELAS_CORES_H
+#define TABELAS_CORES_H
+
+#include <stdint.h>
+#include "arvore_cores.h"
+#include "cor_lab.h"
+
+#define TABELAS_CORES_NUM_CORES {len(cores)}
+#define TABELAS_CORES_HASH 0x{hash_paleta(cores):08X}u // Muda junto com qualquer cor da paleta
+
+// Paleta, na ordem do arquivo. Cada vetor é contíguo em flash, então as
+// varreduras leem a memória em sequência.
+extern const uint8_t cores_rgb_sensor[TABELAS_CORES_NUM_CORES][3]; // Valor lido pelo sensor
+extern const uint8_t cores_rgb_ideal[TABELAS_CORES_NUM_CORES][3];  // Valor perceptivo ideal
+extern const uint16_t cores_nome_deslocamento[TABELAS_CORES_NUM_CORES];
+extern const char cores_nomes[{tamanho_nomes}]; // Nomes terminados em '\\0', um após o outro
+
+static inline const char *tabelas_cores_nome(uint16_t indice)
+{{
+    return &cores_nomes[cores_nome_deslocamento[indice]];
+}}
+
+// Árvore k-d implícita com todas as cores da base.
+extern const arvore_cores_t arvore_cores;
+
+// Lab de cada cor da paleta (valores lidos pelo sensor).
+extern const cor_lab_t lab_cores[TABELAS_CORES_NUM_CORES];
+
+// Tabelas da conversão de cor_lab.c.
+#define LAB_RAIZ_ENTRADAS {len(lab_raiz)}
+extern const uint16_t lab_srgb_linear[256];            // sRGB -> linear, Q15
+extern const int16_t lab_matriz[3][3];                  // sRGB linear -> X/Xn, Y/Yn, Z/Zn, Q14
+extern const uint16_t lab_raiz_cubica[LAB_RAIZ_ENTRADAS]; // f(t) do CIELAB a cada 32 passos de t, Q15
+"""
+
+    c = f"""// Gerado por tools/gerar_tabelas_cores.py. NÃO EDITE.
+#include "tabelas_cores.h"
+
+const uint8_t cores_rgb_sensor[TABELAS_CORES_NUM_CORES][3] = {{
+{sensor}
+}};
+
+const uint8_t cores_rgb_ideal[TABELAS_CORES_NUM_CORES][3] = {{
+{ideal}
+}};
+
+const uint16_t cores_nome_deslocamento[TABELAS_CORES_NUM_CORES] = {{
+{formatar_vetor(deslocamentos)}
+}};
+
+const char cores_nomes[{tamanho_nomes}] =
+{nomes};
+
+static const uint8_t arvore_cores_ponto[{len(cores)}][3] = {{
+{pontos}
+}};
+
+static const uint16_t arvore_cores_indice[{len(cores)}] = {{
+{formatar_vetor(ordem)}
+}};
+
+static const uint8_t arvore_cores_eixo[{len(cores)}] = {{
+{formatar_vetor(eixo)}
+}};
+
+const arvore_cores_t arvore_cores = {{
+    .ponto = arvore_cores_ponto,
+    .indice = arvore_cores_indice,
+    .eixo = arvore_cores_eixo,
+    .num_nos = {len(cores)},
+}};
+
+const cor_lab_t lab_cores[TABELAS_CORES_NUM_CORES] = {{
+{lab}
+}};
+
+const uint16_t lab_srgb_linear[256] = {{
+{formatar_vetor(lab_linear)}
+}};
+
+const int16_t lab_matriz[3][3] = {{
+{matriz}
+}};
+
+const uint16_t lab_raiz_cubica[LAB_RAIZ_ENTRADAS] = {{
+{formatar_vetor(lab_raiz)}
+}};
+"""
+
+    resumo = f"tabelas_cores: {len(cores)} cores (hash {hash_paleta(cores):08X}), árvore k-d"
+    if motor == "lut":
+        if len(cores) > 255:
+            sys.exit("A LUT guarda índices de 8 bits: no máximo 255 cores (use --motor kdtree)")
+
+        indice, conjunto, conjuntos = gerar_lut(cores)
+        inicio = [0]
+        candidatas = []
+        for cj in conjuntos:
+            candidatas.extend(cj)
+            inicio.append(len(candidatas))
+        if len(candidatas) > 0xFFFF:
+            sys.exit("Candidatas da LUT demais para índices de 16 bits (use --motor kdtree)")
+
+        h += f"""
+// Motor de identificação: LUT 3D.
+#define TABELAS_CORES_LUT 1
+#define TABELAS_CORES_LAB 0
+
+// LUT 3D: célula = (r >> 3) << 10 | (g >> 3) << 5 | (b >> 3)
+#define LUT_CORES_BITS {LUT_BITS}
+#define LUT_CORES_CELULAS {LUT_LADO ** 3}
+#define LUT_CORES_CELULA(r, g, b) \\
+    ((((uint32_t)(r) >> {8 - LUT_BITS}) << {2 * LUT_BITS}) | (((uint32_t)(g) >> {8 - LUT_BITS}) << {LUT_BITS}) | ((uint32_t)(b) >> {8 - LUT_BITS}))
+
+// Cor mais próxima do centro de cada célula.
+extern const uint8_t lut_cores_indice[LUT_CORES_CELULAS];
+// Cada conjunto de candidatas tem toda cor que pode estar entre as LUT_CORES_VIZINHOS
+// mais próximas de algum ponto da célula, em ordem de índice.
+#define LUT_CORES_VIZINHOS {LUT_VIZINHOS}
+// 0: a cor de lut_cores_indice vale para a célula inteira (base com uma cor).
+// n > 0: as candidatas são
+// lut_cores_candidatas[lut_cores_conjunto_inicio[n - 1] .. lut_cores_conjunto_inicio[n] - 1].
+extern const uint16_t lut_cores_conjunto[LUT_CORES_CELULAS];
+extern const uint16_t lut_cores_conjunto_inicio[{len(inicio)}];
+extern const uint8_t lut_cores_candidatas[{max(len(candidatas), 1)}];
+"""
+
+        c += f"""
+const uint8_t lut_cores_indice[LUT_CORES_CELULAS] = {{
+{formatar_vetor(indice)}
+}};
+
+const uint16_t lut_cores_conjunto[LUT_CORES_CELULAS] = {{
+{formatar_vetor(conjunto)}
+}};
+
+const uint16_t lut_cores_conjunto_inicio[{len(inicio)}] = {{
+{formatar_vetor(inicio)}
+}};
+
+const uint8_t lut_cores_candidatas[{max(len(candidatas), 1)}] = {{
+{formatar_vetor(candidatas or [0])}
+}};
+"""
+        media = sum(len(conjuntos[v - 1]) for v in conjunto if v) / len(conjunto)
+        resumo += (f", LUT com {len(conjuntos)} conjuntos ({len(candidatas)} candidatas, "
+                   f"{media:.1f} por célula)")
+    elif motor == "lab":
+        h += """
+// Motor de identificação: distância perceptiva em CIELAB (ΔE76; ΔE2000 nas candidatas só com
+// IDENTIFICADOR_LAB_DELTA_E2000).
+#define TABELAS_CORES_LUT 0
+#define TABELAS_CORES_LAB 1
+"""
+    else:
+        h += """
+// Motor de identificação: árvore k-d.
+#define TABELAS_CORES_LUT 0
+#define TABELAS_CORES_LAB 0
+"""
+
+    h += """
+#endif // TABELAS_CORES_H
+"""
+
+    os.makedirs(saida, exist_ok=True)
+    escrever_se_mudou(os.path.join(saida, "tabelas_cores.h"), h)
+    escrever_se_mudou(os.path.join(saida, "tabelas_cores.c"), c)
+    print(resumo)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    fonte = parser.add_mutually_exclusive_group(required=True)
+    fonte.add_argument("--paleta", help="paleta de cores (.csv ou .json)")
+    fonte.add_argument("--aleatorias", type=int, metavar="N", help="base sintética com N cores (bancada)")
+    parser.add_argument("--semente", type=int, default=1, help="semente da base sintética")
+    parser.add_argument("--motor", choices=("lut", "kdtree", "lab"), default="lut",
+                        help="motor de identificação (árvore k-d e Lab são gerados em todos)")
+    parser.add_argument("--saida", required=True, help="diretório dos arquivos gerados")
+    args = parser.parse_args()
+    cores = ler_paleta(args.paleta) if args.paleta else base_aleatoria(args.aleatorias, args.semente)
+    gerar(cores, args.saida, args.motor)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,539 @@
+#!/usr/bin/env python3
+"""Gera as tabelas das funções de transferência sRGB usadas pelos filtros.
+
+Escreve tabelas_filtros.h / tabelas_filtros.c no diretório de saída
+(executado pelo CMake). As tabelas ficam em flash como dados const.
+
+Tabelas geradas:
+  * sRGB (0-255) -> linear em Q12 (0-4096), 256 entradas.
+  * Linear em Q12 -> sRGB (0-255), 4097 entradas (uma por valor Q12).
+  * Um núcleo 3x3 em Q12 por tipo de daltonismo e severidade: LMS -> RGB x
+    projeção x RGB -> LMS compostas aqui, em precisão dupla. Um tipo novo é
+    só uma entrada a mais em TIPOS_DALTONISMO.
+  * Daltonização (correção, Fidaner et al.): C = I + E (I - S), com S a
+    simulação e E a redistribuição do erro para os canais que o tipo ainda
+    distingue. Como S é linear, C vira outro núcleo 3x3 por tipo e
+    severidade, com o mesmo custo da simulação.
+  * Severidade de 0.0 a 1.0 em passos de 0.1 (tricromacia anômala): as
+    matrizes publicadas por Machado, Oliveira & Fernandes (2009), em RGB
+    linear, para os tipos que as têm (MACHADO_2009). Um tipo sem elas usa
+    (1 - s) I + s D, com D o núcleo do dicromata. Mesmo custo em tempo de
+    execução que o núcleo do dicromata.
+  * Com --motor lut17 ou lut33: a simulação completa de cada tipo
+    amostrada numa grade 17^3 ou 33^3 indexada por sRGB e lida com
+    interpolação tetraédrica em inteiros. O custo deixa de depender do
+    modelo de cor. A grade guarda o linear simulado em Q12 (sem clamp) e a
+    saída passa pela tabela linear -> sRGB: interpolar direto em sRGB
+    atravessa o clamp em 0 e a curva íngreme perto do preto (erro de até
+    70 LSB na protanopia com 17^3).
+
+Antes de escrever, compara as tabelas com as curvas analíticas e falha se
+o erro passar dos limites (a verificação roda em todo build).
+"""
+
+import argparse
+import os
+import sys
+
+LINEAR_BITS = 12
+LINEAR_UM = 1 << LINEAR_BITS
+
+# RGB linear para LMS (Smith & Pokorny, 1975)
+SRGB_PARA_LMS = (
+    (0.4002, 0.7076, -0.0808),
+    (-0.2263, 1.1653, 0.0457),
+    (0.0000, 0.0000, 0.9182),
+)
+
+# LMS para RGB linear (Inversa de Smith & Pokorny, 1975)
+LMS_PARA_SRGB = (
+    (1.8601, -1.1396, 0.2782),
+    (0.3612, 0.6388, 0.0000),
+    (-0.0000, 0.0000, 1.0890),
+)
+
+# Severidades em décimos: 0 (visão normal) a SEVERIDADE_MAX (dicromacia).
+SEVERIDADE_MAX = 10
+
+# Matrizes de projeção no espaço LMS (Brettel, Viénot & Mollon, 1999), o dicromata
+# dos tipos sem matrizes de Machado et al. (MACHADO_2009, abaixo).
+# A ordem define os valores de tipo_daltonismo_t e as opções do menu.
+# Redistribuição do erro na daltonização (Fidaner, Lin & Ozguven, 2005): o que
+# se perde no eixo vermelho-verde vai para G e B; no azul-amarelo, para R e G.
+REDISTRIBUICAO_PROTAN_DEUTAN = (
+    (0.0, 0.0, 0.0),
+    (0.7, 1.0, 0.0),
+    (0.7, 0.0, 1.0),
+)
+REDISTRIBUICAO_TRITAN = (
+    (1.0, 0.0, 0.7),
+    (0.0, 1.0, 0.7),
+    (0.0, 0.0, 0.0),
+)
+
+# (sufixo do enum, nome do dicromata, nome da forma anômala, projeção, redistribuição)
+TIPOS_DALTONISMO = (
+    ("PROTANOPIA", "Protanopia", "Protanomalia", (
+        (0.0000, 2.0234, -2.5258),
+        (0.0000, 1.0000, 0.0000),
+        (0.0000, 0.0000, 1.0000),
+    ), REDISTRIBUICAO_PROTAN_DEUTAN),
+    ("DEUTERANOPIA", "Deuteranopia", "Deuteranomalia", (
+        (1.0000, 0.0000, 0.0000),
+        (0.4942, 0.0000, 0.4854),
+        (0.0000, 0.0000, 1.0000),
+    ), REDISTRIBUICAO_PROTAN_DEUTAN),
+    ("TRITANOPIA", "Tritanopia", "Tritanomalia", (
+        (1.0000, 0.0000, 0.0000),
+        (0.0000, 1.0000, 0.0000),
+        (-0.0393, 0.2319, 0.0000),
+    ), REDISTRIBUICAO_TRITAN),
+)
+
+
+# Matrizes publicadas por Machado, Oliveira & Fernandes (2009), "A Physiologically-based
+# Model for Simulation of Color Vision Deficiency", para severidade 0.0 a 1.0 em passos
+# de 0.1, aplicadas em RGB linear. Um tipo sem entrada aqui usa a mistura
+# (1 - s) I + s D com o núcleo do dicromata (nucleos_severidade).
+MACHADO_2009 = {
+    "PROTANOPIA": (
+        (( 1.000000,  0.000000, -0.000000), ( 0.000000,  1.000000,  0.000000), (-0.000000, -0.000000,  1.000000)),  # 0.0
+        (( 0.856167,  0.182038, -0.038205), ( 0.029342,  0.955115,  0.015544), (-0.002880, -0.001563,  1.004443)),  # 0.1
+        (( 0.734766,  0.334872, -0.069637), ( 0.051840,  0.919198,  0.028963), (-0.004928, -0.004209,  1.009137)),  # 0.2
+        (( 0.630323,  0.465641, -0.095964), ( 0.069181,  0.890046,  0.040773), (-0.006308, -0.007724,  1.014032)),  # 0.3
+        (( 0.539009,  0.579343, -0.118352), ( 0.082546,  0.866121,  0.051332), (-0.007136, -0.011959,  1.019095)),  # 0.4
+        (( 0.458064,  0.679578, -0.137642), ( 0.092785,  0.846313,  0.060902), (-0.007494, -0.016807,  1.024301)),  # 0.5
+        (( 0.385450,  0.769005, -0.154455), ( 0.100526,  0.829802,  0.069673), (-0.007442, -0.022190,  1.029632)),  # 0.6
+        (( 0.319627,  0.849633, -0.169261), ( 0.106241,  0.815969,  0.077790), (-0.007025, -0.028051,  1.035076)),  # 0.7
+        (( 0.259411,  0.923008, -0.182420), ( 0.110296,  0.804340,  0.085364), (-0.006276, -0.034346,  1.040622)),  # 0.8
+        (( 0.203876,  0.990338, -0.194214), ( 0.112975,  0.794542,  0.092483), (-0.005222, -0.041043,  1.046265)),  # 0.9
+        (( 0.152286,  1.052583, -0.204868), ( 0.114503,  0.786281,  0.099216), (-0.003882, -0.048116,  1.051998)),  # 1.0
+    ),
+    "DEUTERANOPIA": (
+        (( 1.000000,  0.000000, -0.000000), ( 0.000000,  1.000000,  0.000000), (-0.000000, -0.000000,  1.000000)),  # 0.0
+        (( 0.866435,  0.177704, -0.044139), ( 0.049567,  0.939063,  0.011370), (-0.003453,  0.007233,  0.996220)),  # 0.1
+        (( 0.760729,  0.319078, -0.079807), ( 0.090568,  0.889315,  0.020117), (-0.006027,  0.013325,  0.992702)),  # 0.2
+        (( 0.675425,  0.433850, -0.109275), ( 0.125303,  0.847755,  0.026942), (-0.007950,  0.018572,  0.989378)),  # 0.3
+        (( 0.605511,  0.528560, -0.134071), ( 0.155318,  0.812366,  0.032316), (-0.009376,  0.023176,  0.986200)),  # 0.4
+        (( 0.547494,  0.607765, -0.155259), ( 0.181692,  0.781742,  0.036566), (-0.010410,  0.027275,  0.983136)),  # 0.5
+        (( 0.498864,  0.674741, -0.173604), ( 0.205199,  0.754872,  0.039929), (-0.011131,  0.030969,  0.980162)),  # 0.6
+        (( 0.457771,  0.731899, -0.189670), ( 0.226409,  0.731012,  0.042579), (-0.011595,  0.034333,  0.977261)),  # 0.7
+        (( 0.422823,  0.781057, -0.203881), ( 0.245752,  0.709602,  0.044646), (-0.011843,  0.037423,  0.974421)),  # 0.8
+        (( 0.392952,  0.823610, -0.216562), ( 0.263559,  0.690210,  0.046232), (-0.011910,  0.040281,  0.971630)),  # 0.9
+        (( 0.367322,  0.860646, -0.227968), ( 0.280085,  0.672501,  0.047413), (-0.011820,  0.042940,  0.968881)),  # 1.0
+    ),
+    "TRITANOPIA": (
+        (( 1.000000,  0.000000, -0.000000), ( 0.000000,  1.000000,  0.000000), (-0.000000, -0.000000,  1.000000)),  # 0.0
+        (( 0.926670,  0.092514, -0.019184), ( 0.021191,  0.964503,  0.014306), ( 0.008437,  0.054813,  0.936750)),  # 0.1
+        (( 0.895720,  0.133330, -0.029050), ( 0.029997,  0.945400,  0.024603), ( 0.013027,  0.104707,  0.882266)),  # 0.2
+        (( 0.905871,  0.127791, -0.033662), ( 0.026856,  0.941251,  0.031893), ( 0.013410,  0.148296,  0.838294)),  # 0.3
+        (( 0.948035,  0.089490, -0.037526), ( 0.014364,  0.946792,  0.038844), ( 0.010853,  0.193991,  0.795156)),  # 0.4
+        (( 1.017277,  0.027029, -0.044306), (-0.006113,  0.958479,  0.047634), ( 0.006379,  0.248708,  0.744913)),  # 0.5
+        (( 1.104996, -0.046633, -0.058363), (-0.032137,  0.971635,  0.060503), ( 0.001336,  0.317922,  0.680742)),  # 0.6
+        (( 1.193214, -0.109812, -0.083402), (-0.058496,  0.979410,  0.079086), (-0.002346,  0.403492,  0.598854)),  # 0.7
+        (( 1.257728, -0.139648, -0.118081), (-0.078003,  0.975409,  0.102594), (-0.003316,  0.501214,  0.502102)),  # 0.8
+        (( 1.278864, -0.125333, -0.153531), (-0.084748,  0.957674,  0.127074), (-0.000989,  0.601151,  0.399838)),  # 0.9
+        (( 1.255528, -0.076749, -0.178779), (-0.078411,  0.930809,  0.147602), ( 0.004733,  0.691367,  0.303900)),  # 1.0
+    ),
+}
+
+
+def srgb_para_linear(c):
+    c /= 255.0
+    return c / 12.92 if c <= 0.04045 else ((c + 0.055) / 1.055) ** 2.4
+
+
+def linear_para_srgb(v):
+    v = min(max(v, 0.0), 1.0)
+    s = v * 12.92 if v <= 0.0031308 else 1.055 * v ** (1 / 2.4) - 0.055
+    return s * 255.0
+
+
+def gerar_tabelas():
+    direta = [round(srgb_para_linear(c) * LINEAR_UM) for c in range(256)]
+    inversa = [round(linear_para_srgb(i / LINEAR_UM)) for i in range(LINEAR_UM + 1)]
+    return direta, inversa
+
+
+def multiplicar(a, b):
+    return tuple(tuple(sum(a[i][k] * b[k][j] for k in range(3)) for j in range(3)) for i in range(3))
+
+
+def quantizar(m):
+    q12 = tuple(tuple(round(v * LINEAR_UM) for v in linha) for linha in m)
+    if any(abs(v) > 32767 for linha in q12 for v in linha):
+        sys.exit("tabelas_filtros: coeficiente do núcleo não cabe em int16")
+    return q12
+
+
+def compor_nucleos():
+    """Devolve, por tipo, o núcleo do dicromata em double e em Q12 (LMS->RGB x projeção x RGB->LMS)."""
+    nucleos = []
+    for projecao in (t[3] for t in TIPOS_DALTONISMO):
+        m = multiplicar(LMS_PARA_SRGB, multiplicar(projecao, SRGB_PARA_LMS))
+        nucleos.append((m, quantizar(m)))
+    return nucleos
+
+
+def nucleos_severidade(tipo, m):
+    """Núcleos de severidade 0 a SEVERIDADE_MAX, em double e em Q12.
+
+    As matrizes de Machado et al. quando o tipo as tem; senão, (1 - s) I + s D.
+    """
+    if tipo in MACHADO_2009:
+        return [(ms, quantizar(ms)) for ms in MACHADO_2009[tipo]]
+    saida = []
+    for passo in range(SEVERIDADE_MAX + 1):
+        s = passo / SEVERIDADE_MAX
+        ms = tuple(tuple((1 - s) * (i == j) + s * m[i][j] for j in range(3)) for i in range(3))
+        saida.append((ms, quantizar(ms)))
+    return saida
+
+
+def verificar_machado():
+    """Confere a transcrição das matrizes de Machado et al.: uma por severidade,
+    identidade em 0.0 e linhas somando 1 (o branco não muda), dentro do arredondamento publicado."""
+    falhas = []
+    for tipo, matrizes in MACHADO_2009.items():
+        if tipo not in (t[0] for t in TIPOS_DALTONISMO):
+            falhas.append(f"{tipo}: tipo desconhecido")
+        if len(matrizes) != SEVERIDADE_MAX + 1:
+            falhas.append(f"{tipo}: {len(matrizes)} matrizes (esperado {SEVERIDADE_MAX + 1})")
+        if any(abs(matrizes[0][i][j] - (i == j)) > 1e-6 for i in range(3) for j in range(3)):
+            falhas.append(f"{tipo}: severidade 0.0 não é a identidade")
+        for passo, ms in enumerate(matrizes):
+            for i, linha in enumerate(ms):
+                if abs(sum(linha) - 1.0) > 5e-6:
+                    falhas.append(f"{tipo} {passo / SEVERIDADE_MAX:.1f}: linha {i} soma {sum(linha):.6f}")
+    if falhas:
+        sys.exit("tabelas_filtros: MACHADO_2009: " + "; ".join(falhas))
+
+
+def nucleos_correcao(severidades, redistribuicao):
+    """Daltonização por severidade: I + E (I - S), em double e em Q12."""
+    saida = []
+    for ms, _ in severidades:
+        erro = tuple(tuple((i == j) - ms[i][j] for j in range(3)) for i in range(3))
+        e_erro = multiplicar(redistribuicao, erro)
+        mc = tuple(tuple((i == j) + e_erro[i][j] for j in range(3)) for i in range(3))
+        saida.append((mc, quantizar(mc)))
+    return saida
+
+
+def verificar_nucleos(direta, inversa, nucleos, passo=12):
+    """Maior diferença (em LSB sRGB) entre o núcleo Q12 com tabelas e as três matrizes em double."""
+    pior = []
+    for m, q12 in nucleos:
+        erro = 0
+        for r in range(0, 256, passo):
+            for g in range(0, 256, passo):
+                for b in range(0, 256, passo):
+                    lin = [srgb_para_linear(c) for c in (r, g, b)]
+                    lin_q12 = [direta[c] for c in (r, g, b)]
+                    for i in range(3):
+                        exato = round(linear_para_srgb(sum(m[i][j] * lin[j] for j in range(3))))
+                        acc = (sum(q12[i][j] * lin_q12[j] for j in range(3)) + (LINEAR_UM >> 1)) >> LINEAR_BITS
+                        obtido = inversa[min(max(acc, 0), LINEAR_UM)]
+                        erro = max(erro, abs(obtido - exato))
+        pior.append(erro)
+    return pior
+
+
+def simular(m, rgb):
+    """Caminho analítico em precisão dupla: sRGB (contínuo, 0-255) -> sRGB simulado (0-255)."""
+    lin = [srgb_para_linear(c) for c in rgb]
+    return [linear_para_srgb(sum(m[i][j] * lin[j] for j in range(3))) for i in range(3)]
+
+
+def simular_q12(direta, inversa, q12, rgb):
+    """O caminho analítico do firmware (núcleo Q12 com tabelas), bit a bit."""
+    lin = [direta[c] for c in rgb]
+    saida = []
+    for i in range(3):
+        acc = (sum(q12[i][j] * lin[j] for j in range(3)) + (LINEAR_UM >> 1)) >> LINEAR_BITS
+        saida.append(inversa[min(max(acc, 0), LINEAR_UM)])
+    return saida
+
+
+def posicoes_grade(lado):
+    """Célula e peso (Q8, 0-256) de cada valor 0-255 numa grade de `lado` pontos por eixo."""
+    celula, peso = [], []
+    for v in range(256):
+        pos = v * (lado - 1)
+        i = min(pos // 255, lado - 2)  # 255 fica na última célula, com peso 256
+        celula.append(i)
+        peso.append(round((pos - i * 255) * 256 / 255))
+    return celula, peso
+
+
+def gerar_luts(nucleos, lado):
+    """Grade lado^3 x RGB por tipo (índice = (r * lado + g) * lado + b): linear simulado em Q12, em double."""
+    luts = []
+    for m, _ in nucleos:
+        lut = []
+        for ir in range(lado):
+            for ig in range(lado):
+                for ib in range(lado):
+                    lin = [srgb_para_linear(i * 255.0 / (lado - 1)) for i in (ir, ig, ib)]
+                    lut.append([round(sum(m[k][j] * lin[j] for j in range(3)) * LINEAR_UM) for k in range(3)])
+        if any(abs(v) > 32767 for p in lut for v in p):
+            sys.exit("tabelas_filtros: ponto da LUT não cabe em int16")
+        luts.append(lut)
+    return luts
+
+
+def interpolar(lut, lado, celula, peso, rgb):
+    """Interpolação tetraédrica, como em filtros_daltonismo.c."""
+    i = [celula[c] for c in rgb]
+    f = [peso[c] for c in rgb]
+    passo = (lado * lado, lado, 1)
+    base = i[0] * passo[0] + i[1] * passo[1] + i[2] * passo[2]
+    # Eixos em ordem decrescente de peso; empates pela ordem R, G, B.
+    ordem = sorted(range(3), key=lambda e: -f[e])
+    v1 = base + passo[ordem[0]]
+    v2 = v1 + passo[ordem[1]]
+    v3 = v2 + passo[ordem[2]]
+    f1, f2, f3 = (f[e] for e in ordem)
+    return [(lut[base][k] * (256 - f1) + lut[v1][k] * (f1 - f2) + lut[v2][k] * (f2 - f3)
+             + lut[v3][k] * f3 + 128) >> 8 for k in range(3)]
+
+
+def verificar_luts(direta, inversa, nucleos, luts, lado):
+    """Maior diferença (LSB sRGB) da LUT interpolada contra o núcleo Q12 e contra o caminho em double."""
+    celula, peso = posicoes_grade(lado)
+    # Passo primo com a grade, para cair em posições diferentes de cada célula.
+    valores = list(range(0, 256, 7)) + [255]
+    erros = []
+    for (m, q12), lut in zip(nucleos, luts):
+        erro_q12 = erro_exato = 0
+        for r in valores:
+            for g in valores:
+                for b in valores:
+                    obtido = [inversa[min(max(v, 0), LINEAR_UM)]
+                              for v in interpolar(lut, lado, celula, peso, (r, g, b))]
+                    q = simular_q12(direta, inversa, q12, (r, g, b))
+                    e = simular(m, (r, g, b))
+                    for k in range(3):
+                        erro_q12 = max(erro_q12, abs(obtido[k] - q[k]))
+                        erro_exato = max(erro_exato, abs(obtido[k] - e[k]))
+        erros.append((erro_q12, erro_exato))
+    return erros
+
+
+def verificar(direta, inversa):
+    """Devolve as linhas do relatório; encerra com erro se algum limite for violado."""
+    erro_direta = max(abs(direta[c] - srgb_para_linear(c) * LINEAR_UM) for c in range(256))
+    erro_inversa = max(abs(inversa[i] - linear_para_srgb(i / LINEAR_UM)) for i in range(LINEAR_UM + 1))
+    ida_e_volta = sum(1 for c in range(256) if inversa[direta[c]] != c)
+    # Entrada fora da grade Q12: o pior caso é meio passo de Q12 antes do arredondamento.
+    erro_continuo = 0.0
+    for i in range(LINEAR_UM * 4 + 1):
+        v = i / (LINEAR_UM * 4)
+        erro_continuo = max(erro_continuo, abs(inversa[round(v * LINEAR_UM)] - linear_para_srgb(v)))
+
+    falhas = []
+    if erro_direta > 0.5:
+        falhas.append(f"sRGB -> linear: erro {erro_direta:.3f} LSB Q12 (máx. 0.5)")
+    if erro_inversa > 0.5:
+        falhas.append(f"linear -> sRGB: erro {erro_inversa:.3f} LSB (máx. 0.5)")
+    if ida_e_volta:
+        falhas.append(f"ida e volta: {ida_e_volta} valores não voltam ao original")
+    if erro_continuo > 1.0:
+        falhas.append(f"linear contínuo -> sRGB: erro {erro_continuo:.3f} LSB (máx. 1.0)")
+    if falhas:
+        sys.exit("tabelas_filtros: " + "; ".join(falhas))
+
+    return (f"sRGB->linear erro máx. {erro_direta:.3f} LSB Q12, linear->sRGB {erro_inversa:.3f} LSB "
+            f"({erro_continuo:.3f} com entrada contínua), ida e volta exata")
+
+
+def formatar_vetor(valores, por_linha=16):
+    linhas = []
+    for i in range(0, len(valores), por_linha):
+        linhas.append("    " + ", ".join(str(v) for v in valores[i:i + por_linha]) + ",")
+    return "\n".join(linhas)
+
+
+def escrever_se_mudou(caminho, conteudo):
+    # Não reescreve arquivos iguais, para não forçar recompilações.
+    if os.path.exists(caminho):
+        with open(caminho, encoding="utf-8") as f:
+            if f.read() == conteudo:
+                return
+    with open(caminho, "w", encoding="utf-8") as f:
+        f.write(conteudo)
+
+
+def gerar(saida, motor):
+    direta, inversa = gerar_tabelas()
+    relatorio = verificar(direta, inversa)
+    verificar_machado()
+    severidades = [nucleos_severidade(t[0], m) for t, (m, _) in zip(TIPOS_DALTONISMO, compor_nucleos())]
+    # Dicromata: a severidade máxima (a grade do motor LUT é a dele).
+    nucleos = [ns[-1] for ns in severidades]
+    # Dicromata na grade fina; severidades intermediárias numa grade mais grossa (mesma conta).
+    erros_nucleos = [max(verificar_nucleos(direta, inversa, [ns[-1]])
+                         + verificar_nucleos(direta, inversa, ns[:-1], passo=51)) for ns in severidades]
+    relatorio += "; núcleos fundidos (todas as severidades), erro máx. " + ", ".join(
+        f"{t[1]} {e} LSB" for t, e in zip(TIPOS_DALTONISMO, erros_nucleos))
+    correcoes = [nucleos_correcao(ns, t[4]) for ns, t in zip(severidades, TIPOS_DALTONISMO)]
+    erros_correcao = [max(verificar_nucleos(direta, inversa, [nc[-1]])
+                          + verificar_nucleos(direta, inversa, nc[:-1], passo=51)) for nc in correcoes]
+    relatorio += "; daltonização, erro máx. " + ", ".join(
+        f"{t[1]} {e} LSB" for t, e in zip(TIPOS_DALTONISMO, erros_correcao))
+
+    tipos = "\n".join(f"    DALTONISMO_{t[0]}," for t in TIPOS_DALTONISMO)
+    nomes = "\n".join(f'    "{t[1]}",' for t in TIPOS_DALTONISMO)
+    nomes_anomalia = "\n".join(f'    "{t[2]}",' for t in TIPOS_DALTONISMO)
+
+    def formatar_nucleos(por_tipo):
+        return "\n".join(
+            f"    // {t[1]}\n    {{\n"
+            + "\n".join("        {" + ", ".join("{" + ", ".join(str(v) for v in linha) + "}" for linha in q12) + "},"
+                         + f" // {passo / SEVERIDADE_MAX:.1f}"
+                         for passo, (_, q12) in enumerate(ns))
+            + "\n    },"
+            for t, ns in zip(TIPOS_DALTONISMO, por_tipo))
+
+    matrizes = formatar_nucleos(severidades)
+    matrizes_correcao = formatar_nucleos(correcoes)
+    redistribuicoes = "\n".join(
+        f"    // {t[1]}\n    {{" + ", ".join("{" + ", ".join(str(v) for v in linha) + "}" for linha in quantizar(t[4])) + "},"
+        for t in TIPOS_DALTONISMO)
+
+    h = f"""// Gerado por tools/gerar_tabelas_filtros.py. NÃO EDITE.
+#ifndef TABELAS_FILTROS_H
+#define TABELAS_FILTROS_H
+
+#include <stdint.h>
+
+#define TABELAS_FILTROS_LINEAR_BITS {LINEAR_BITS}
+#define TABELAS_FILTROS_LINEAR_UM {LINEAR_UM}
+
+// sRGB (0-255) -> linear em Q{LINEAR_BITS}.
+extern const uint16_t tabela_srgb_linear[256];
+// Linear em Q{LINEAR_BITS} (0-{LINEAR_UM}) -> sRGB (0-255).
+extern const uint8_t tabela_linear_srgb[{LINEAR_UM + 1}];
+
+// Tipos de daltonismo simulados, na ordem de tools/gerar_tabelas_filtros.py.
+typedef enum {{
+{tipos}
+    DALTONISMO_NUM_TIPOS
+}} tipo_daltonismo_t;
+
+// Severidade em décimos: 0 = visão normal, DALTONISMO_SEVERIDADE_MAX = dicromacia.
+#define DALTONISMO_SEVERIDADE_MAX {SEVERIDADE_MAX}
+#define DALTONISMO_NUM_SEVERIDADES {SEVERIDADE_MAX + 1}
+
+// Nome do dicromata (severidade máxima) e da forma anômala (severidade parcial).
+extern const char *const daltonismo_nomes[DALTONISMO_NUM_TIPOS];
+extern const char *const daltonismo_nomes_anomalia[DALTONISMO_NUM_TIPOS];
+// RGB linear -> RGB linear simulado, em Q{LINEAR_BITS}: as três matrizes já compostas,
+// uma por severidade.
+extern const int16_t daltonismo_nucleo_q12[DALTONISMO_NUM_TIPOS][DALTONISMO_NUM_SEVERIDADES][3][3];
+// Daltonização (cor corrigida), também em RGB linear Q{LINEAR_BITS}: I + E (I - S) já composto.
+extern const int16_t daltonismo_correcao_q12[DALTONISMO_NUM_TIPOS][DALTONISMO_NUM_SEVERIDADES][3][3];
+// E, a redistribuição do erro, para quem calcula S por outro caminho (LUT).
+extern const int16_t daltonismo_redistribuicao_q12[DALTONISMO_NUM_TIPOS][3][3];
+
+"""
+
+    c = f"""// Gerado por tools/gerar_tabelas_filtros.py. NÃO EDITE.
+#include "tabelas_filtros.h"
+
+const uint16_t tabela_srgb_linear[256] = {{
+{formatar_vetor(direta)}
+}};
+
+const uint8_t tabela_linear_srgb[{LINEAR_UM + 1}] = {{
+{formatar_vetor(inversa)}
+}};
+
+const char *const daltonismo_nomes[DALTONISMO_NUM_TIPOS] = {{
+{nomes}
+}};
+
+const char *const daltonismo_nomes_anomalia[DALTONISMO_NUM_TIPOS] = {{
+{nomes_anomalia}
+}};
+
+const int16_t daltonismo_nucleo_q12[DALTONISMO_NUM_TIPOS][DALTONISMO_NUM_SEVERIDADES][3][3] = {{
+{matrizes}
+}};
+
+const int16_t daltonismo_correcao_q12[DALTONISMO_NUM_TIPOS][DALTONISMO_NUM_SEVERIDADES][3][3] = {{
+{matrizes_correcao}
+}};
+
+const int16_t daltonismo_redistribuicao_q12[DALTONISMO_NUM_TIPOS][3][3] = {{
+{redistribuicoes}
+}};
+"""
+
+    if motor == "matriz":
+        h += """
+// Motor de simulação: núcleo 3x3 por pixel.
+#define TABELAS_FILTROS_LUT 0
+"""
+    else:
+        lado = int(motor[3:])
+        luts = gerar_luts(nucleos, lado)
+        celula, peso = posicoes_grade(lado)
+        erros_lut = verificar_luts(direta, inversa, nucleos, luts, lado)
+        relatorio += f"; LUT {lado}^3, erro máx. " + ", ".join(
+            f"{t[1]} {eq} LSB ({ee:.2f} contra double)" for t, (eq, ee) in zip(TIPOS_DALTONISMO, erros_lut))
+
+        h += f"""
+// Motor de simulação: LUT 3D {lado}^3 por tipo, com interpolação tetraédrica.
+#define TABELAS_FILTROS_LUT 1
+#define DALTONISMO_LUT_LADO {lado}
+#define DALTONISMO_LUT_PONTOS ({lado} * {lado} * {lado})
+
+// RGB linear simulado em Q{LINEAR_BITS} (severidade máxima), sem clamp, nos pontos da grade
+// (indexada por sRGB); ponto (r, g, b) = (r * LADO + g) * LADO + b.
+extern const int16_t daltonismo_lut[DALTONISMO_NUM_TIPOS][DALTONISMO_LUT_PONTOS][3];
+// Para cada valor 0-255: célula da grade (0 a LADO - 2) e posição dentro dela em Q8 (0-256).
+extern const uint8_t daltonismo_lut_celula[256];
+extern const uint16_t daltonismo_lut_peso[256];
+"""
+        grades = "\n".join(
+            f"    // {t[1]}\n    {{\n"
+            + "\n".join("        " + " ".join("{" + ", ".join(str(v) for v in p) + "},"
+                                            for p in lut[i:i + 8]) for i in range(0, len(lut), 8))
+            + "\n    },"
+            for t, lut in zip(TIPOS_DALTONISMO, luts))
+        c += f"""
+const int16_t daltonismo_lut[DALTONISMO_NUM_TIPOS][DALTONISMO_LUT_PONTOS][3] = {{
+{grades}
+}};
+
+const uint8_t daltonismo_lut_celula[256] = {{
+{formatar_vetor(celula)}
+}};
+
+const uint16_t daltonismo_lut_peso[256] = {{
+{formatar_vetor(peso)}
+}};
+"""
+
+    h += """
+#endif // TABELAS_FILTROS_H
+"""
+
+    os.makedirs(saida, exist_ok=True)
+    escrever_se_mudou(os.path.join(saida, "tabelas_filtros.h"), h)
+    escrever_se_mudou(os.path.join(saida, "tabelas_filtros.c"), c)
+    print("tabelas_filtros: " + relatorio)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--saida", required=True, help="diretório dos arquivos gerados")
+    parser.add_argument("--motor", choices=("matriz", "lut17", "lut33"), default="matriz",
+                        help="motor de simulação (o núcleo 3x3 é gerado em todos)")
+    args = parser.parse_args()
+    gerar(args.saida, args.motor)
+
+
+if __name__ == "__main__":
+    main()
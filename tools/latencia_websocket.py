@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+"""Mede, do PC, a latência de ponta a ponta do WebSocket do aparelho (GET /ws).
+
+Conecta-se ao aparelho (rede Coresenxergo_AP), estima o período do sensor pelos
+tempos das amostras recebidas e, em seguida, alterna a severidade por comando,
+cronometrando do envio do comando até a primeira amostra que já a reflete. Isso
+inclui a espera pela próxima conversão do sensor: em rede ociosa, a mediana deve
+ficar abaixo de um período do sensor.
+
+Formato dos quadros: ver canal_websocket.h. Só usa a biblioteca padrão.
+
+Uso: tools/latencia_websocket.py [--host 192.168.4.1] [--tentativas 20]
+Sai com código 1 se a mediana passar de um período do sensor.
+"""
+
+import argparse
+import base64
+import hashlib
+import os
+import socket
+import statistics
+import struct
+import sys
+import time
+
+GUID = b"258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+
+WEBSOCKET_AMOSTRA = 0x01
+WEBSOCKET_RESPOSTA = 0x02
+WEBSOCKET_CMD_SEVERIDADE = 0x02
+
+OP_BINARIO = 0x2
+OP_FECHAR = 0x8
+
+
+def ler_exato(sock, n):
+    dados = b""
+    while len(dados) < n:
+        parte = sock.recv(n - len(dados))
+        if not parte:
+            raise ConnectionError("conexão encerrada pelo aparelho")
+        dados += parte
+    return dados
+
+
+def conectar(host, porta, prazo):
+    sock = socket.create_connection((host, porta), timeout=prazo)
+    sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+    chave = base64.b64encode(os.urandom(16))
+    sock.sendall(b"GET /ws HTTP/1.1\r\nHost: " + host.encode() + b"\r\n"
+                 b"Upgrade: websocket\r\nConnection: Upgrade\r\n"
+                 b"Sec-WebSocket-Key: " + chave + b"\r\nSec-WebSocket-Version: 13\r\n\r\n")
+    resposta = b""
+    while b"\r\n\r\n" not in resposta:
+        resposta += ler_exato(sock, 1)
+    esperado = base64.b64encode(hashlib.sha1(chave + GUID).digest())
+    if b" 101 " not in resposta.split(b"\r\n")[0] or esperado not in resposta:
+        raise ConnectionError("handshake recusado:\n" + resposta.decode(errors="replace"))
+    return sock
+
+
+def ler_quadro(sock):
+    """Devolve (opcode, carga) do próximo quadro do aparelho (sem máscara)."""
+    b0, b1 = ler_exato(sock, 2)
+    n = b1 & 0x7F
+    if n == 126:
+        n = struct.unpack(">H", ler_exato(sock, 2))[0]
+    elif n == 127:
+        n = struct.unpack(">Q", ler_exato(sock, 8))[0]
+    return b0 & 0x0F, ler_exato(sock, n)
+
+
+def enviar_comando(sock, comando, valor):
+    mascara = os.urandom(4)
+    carga = bytes(b ^ mascara[i % 4] for i, b in enumerate(bytes([comando, valor])))
+    sock.sendall(bytes([0x80 | OP_BINARIO, 0x80 | len(carga)]) + mascara + carga)
+
+
+def proxima_amostra(sock):
+    """Devolve (severidade %, sequência, tempo_us) da próxima amostra."""
+    while True:
+        opcode, carga = ler_quadro(sock)
+        if opcode == OP_FECHAR:
+            raise ConnectionError("o aparelho fechou o WebSocket")
+        if opcode == OP_BINARIO and carga and carga[0] == WEBSOCKET_AMOSTRA:
+            sequencia, tempo_us = struct.unpack_from("<II", carga, 4)
+            return carga[2], sequencia, tempo_us
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--host", default="192.168.4.1")
+    parser.add_argument("--porta", type=int, default=80)
+    parser.add_argument("--tentativas", type=int, default=20)
+    parser.add_argument("--amostras-periodo", type=int, default=30,
+                        help="amostras usadas para estimar o período do sensor")
+    args = parser.parse_args()
+
+    sock = conectar(args.host, args.porta, prazo=5.0)
+
+    # Período do sensor pelo relógio do aparelho (tempo_us tem 32 bits: diferenças módulo 2^32)
+    severidade_inicial, _, tempo_anterior = proxima_amostra(sock)
+    intervalos = []
+    for _ in range(args.amostras_periodo):
+        _, _, tempo = proxima_amostra(sock)
+        intervalos.append(((tempo - tempo_anterior) & 0xFFFFFFFF) / 1000.0)
+        tempo_anterior = tempo
+    periodo_ms = statistics.median(intervalos)
+
+    latencias = []
+    valores = (severidade_inicial, 50 if severidade_inicial != 50 else 100)
+    for i in range(args.tentativas):
+        alvo = valores[(i + 1) % 2]
+        t0 = time.perf_counter()
+        enviar_comando(sock, WEBSOCKET_CMD_SEVERIDADE, alvo)
+        while proxima_amostra(sock)[0] != alvo:
+            pass
+        latencias.append((time.perf_counter() - t0) * 1000.0)
+    if args.tentativas % 2:
+        enviar_comando(sock, WEBSOCKET_CMD_SEVERIDADE, severidade_inicial)
+    sock.close()
+
+    mediana = statistics.median(latencias)
+    print("período do sensor  %6.1f ms (mediana de %d intervalos)" % (periodo_ms, len(intervalos)))
+    print("latência comando->amostra  min %6.1f  mediana %6.1f  max %6.1f ms (%d tentativas)"
+          % (min(latencias), mediana, max(latencias), len(latencias)))
+    return 0 if mediana < periodo_ms else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,214 @@
+// teste_filtro_amostras_host.c
+// Testa, no PC, os três modos de filtro_amostras.c com sequências conhecidas:
+// convergência da EMA, janela da mediana (inclusive a volta do buffer circular),
+// rejeição de outliers pelo MAD e o recomeço depois de filtro_amostras_reiniciar()
+// (troca de exposição). Cada canal recebe a mesma sequência deslocada de
+// DESLOCAMENTO_CANAL * canal; os três modos são invariantes a esse deslocamento,
+// então cada canal deve sair com o esperado mais o próprio deslocamento.
+// Compilado e executado por tools/teste_filtro_amostras_host.sh.
+#include <stdio.h>
+
+#include "filtro_amostras.h"
+
+#define DESLOCAMENTO_CANAL 7
+
+static int falhas;
+
+#define VERIFICAR(cond)                                                  \
+    do                                                                   \
+    {                                                                    \
+        if (!(cond))                                                     \
+        {                                                                \
+            printf("FALHOU %s:%d: %s\n", __FILE__, __LINE__, #cond);    \
+            falhas++;                                                    \
+        }                                                                \
+    } while (0)
+
+// Insere 'valor' (mais o deslocamento de cada canal) e devolve a saída do canal 0,
+// conferindo que os outros canais deram o mesmo resultado deslocado.
+static int alimentar(filtro_amostras_t *f, uint16_t valor)
+{
+    uint16_t entrada[FILTRO_CANAIS];
+    uint16_t saida[FILTRO_CANAIS];
+    for (int c = 0; c < FILTRO_CANAIS; c++)
+    {
+        entrada[c] = valor + DESLOCAMENTO_CANAL * c;
+    }
+    filtro_amostras_processar(f, entrada, saida);
+    for (int c = 1; c < FILTRO_CANAIS; c++)
+    {
+        VERIFICAR(saida[c] == saida[0] + DESLOCAMENTO_CANAL * c);
+    }
+    return saida[0];
+}
+
+// Alimenta a sequência e compara cada saída com a esperada.
+static void conferir(const char *caso, filtro_amostras_t *f, const uint16_t *entrada, const int *esperado,
+                     int n)
+{
+    for (int i = 0; i < n; i++)
+    {
+        int saida = alimentar(f, entrada[i]);
+        if (saida != esperado[i])
+        {
+            printf("FALHOU %s: amostra %d (%u) deu %d, esperado %d\n", caso, i, entrada[i], saida,
+                   esperado[i]);
+            falhas++;
+        }
+    }
+}
+
+#define QUANTIDADE(v) ((int)(sizeof(v) / sizeof((v)[0])))
+
+// --- Casos ---
+
+// EMA com alfa 0.25: a primeira amostra semeia, cada passo anda 1/4 do que falta,
+// sem passar do alvo, e chega ao valor exato (o resíduo em Q8 arredonda para ele).
+static void teste_ema(void)
+{
+    filtro_amostras_t f;
+    filtro_amostras_init(&f, FILTRO_EMA, 5, 64);
+
+    static const uint16_t entrada[] = {1000, 2000, 2000, 2000, 2000};
+    static const int esperado[] = {1000, 1250, 1438, 1578, 1684};
+    conferir("ema degrau", &f, entrada, esperado, QUANTIDADE(entrada));
+
+    int anterior = esperado[QUANTIDADE(esperado) - 1];
+    int passos = 0;
+    while (anterior != 2000 && passos < 100)
+    {
+        int saida = alimentar(&f, 2000);
+        VERIFICAR(saida >= anterior && saida <= 2000);
+        anterior = saida;
+        passos++;
+    }
+    VERIFICAR(anterior == 2000);
+    VERIFICAR(passos <= 40); // (3/4)^n * 1000 abaixo de meia contagem: n ~ 27
+
+    // Descendo também chega ao valor exato e para nele.
+    for (int i = 0; i < 60; i++)
+    {
+        alimentar(&f, 500);
+    }
+    VERIFICAR(alimentar(&f, 500) == 500);
+
+    // alfa 255/256: quase só a amostra nova.
+    filtro_amostras_init(&f, FILTRO_EMA, 5, 255);
+    alimentar(&f, 100);
+    VERIFICAR(alimentar(&f, 3000) == 2989);
+
+    // alfa 256: só a amostra nova, sem suavização; acima disso, limitado a 256.
+    static const uint16_t alfas[] = {256, 1000};
+    for (int a = 0; a < QUANTIDADE(alfas); a++)
+    {
+        filtro_amostras_init(&f, FILTRO_EMA, 5, alfas[a]);
+        static const uint16_t saltos[] = {100, 3000, 7, 65500, 0, 1234};
+        static const int esperado_saltos[] = {100, 3000, 7, 65500, 0, 1234};
+        conferir("ema alfa 256", &f, saltos, esperado_saltos, QUANTIDADE(saltos));
+    }
+}
+
+// Mediana da janela de 5: enquanto a janela enche, mediana das que existem (par: média
+// das duas centrais, arredondada para cima); depois, só as 5 mais recentes.
+static void teste_mediana(void)
+{
+    filtro_amostras_t f;
+    filtro_amostras_init(&f, FILTRO_MEDIANA, 5, 64);
+
+    static const uint16_t entrada[] = {10, 50, 20, 40, 30, 1000, 25, 35, 45};
+    static const int esperado[] = {10, 30, 20, 30, 30, 40, 30, 35, 35};
+    conferir("mediana enchendo", &f, entrada, esperado, QUANTIDADE(entrada));
+
+    // Um pico, ou dois seguidos, somem; três seguidos já são a maioria da janela de 5.
+    filtro_amostras_init(&f, FILTRO_MEDIANA, 5, 64);
+    static const uint16_t picos[] = {100, 100, 100, 100, 100, 9000, 100, 100, 100, 100,
+                                     9000, 9000, 100, 100, 100, 100, 100, 9000, 9000, 9000};
+    static const int esperado_picos[] = {100, 100, 100, 100, 100, 100, 100, 100, 100, 100,
+                                         100, 100, 100, 100, 100, 100, 100, 100, 100, 9000};
+    conferir("mediana picos", &f, picos, esperado_picos, QUANTIDADE(picos));
+
+    // Janela máxima, alimentada por mais de uma volta do buffer circular.
+    filtro_amostras_init(&f, FILTRO_MEDIANA, FILTRO_JANELA_MAX, 64);
+    for (int i = 0; i < 3 * FILTRO_JANELA_MAX; i++)
+    {
+        int saida = alimentar(&f, (uint16_t)(i * 10));
+        int n = (i + 1 < FILTRO_JANELA_MAX) ? i + 1 : FILTRO_JANELA_MAX;
+        // Sequência crescente: a mediana é a média da mais antiga e da mais recente da janela
+        int mais_antiga = i + 1 - n;
+        int esperado_i = (mais_antiga * 10 + i * 10 + 1) / 2;
+        if (saida != esperado_i)
+        {
+            printf("FALHOU mediana circular: amostra %d deu %d, esperado %d\n", i, saida, esperado_i);
+            falhas++;
+        }
+    }
+}
+
+// Média da janela sem as amostras a mais de 3 MAD (+1) da mediana.
+static void teste_outliers(void)
+{
+    filtro_amostras_t f;
+    filtro_amostras_init(&f, FILTRO_REJEITA_OUTLIERS, 7, 64);
+
+    // Mediana 100, MAD 1, limiar 4: o 5000 fica de fora (a média simples daria 786).
+    static const uint16_t ruido[] = {100, 102, 98, 101, 99, 100, 5000};
+    static const int esperado_ruido[] = {100, 101, 100, 100, 100, 100, 100};
+    conferir("mad ruido", &f, ruido, esperado_ruido, QUANTIDADE(ruido));
+
+    // Outlier abaixo da mediana também sai.
+    static const uint16_t abaixo[] = {0, 100, 100, 100, 100, 100, 100, 100};
+    static const int esperado_abaixo[] = {100, 100, 100, 100, 100, 100, 100, 100};
+    conferir("mad abaixo", &f, abaixo, esperado_abaixo, QUANTIDADE(abaixo));
+
+    // Janela sem ruído (MAD 0): o limiar é 1 contagem, e 2 de diferença já saem.
+    filtro_amostras_init(&f, FILTRO_REJEITA_OUTLIERS, 7, 64);
+    static const uint16_t plana[] = {500, 500, 500, 500, 500, 500, 502, 502};
+    static const int esperado_plana[] = {500, 500, 500, 500, 500, 500, 500, 500};
+    conferir("mad plana", &f, plana, esperado_plana, QUANTIDADE(plana));
+
+    // Degrau verdadeiro: segue o nível novo assim que ele é a maioria da janela.
+    filtro_amostras_init(&f, FILTRO_REJEITA_OUTLIERS, 7, 64);
+    static const uint16_t degrau[] = {100, 100, 100, 100, 200, 200, 200, 200, 200};
+    static const int esperado_degrau[] = {100, 100, 100, 100, 100, 100, 100, 200, 200};
+    conferir("mad degrau", &f, degrau, esperado_degrau, QUANTIDADE(degrau));
+}
+
+// Depois de filtro_amostras_reiniciar() (exposição nova), nada do histórico antigo
+// entra na saída, em nenhum modo.
+static void teste_reinicio(void)
+{
+    static const filtro_modo_t modos[] = {FILTRO_EMA, FILTRO_MEDIANA, FILTRO_REJEITA_OUTLIERS};
+    for (int m = 0; m < QUANTIDADE(modos); m++)
+    {
+        filtro_amostras_t f;
+        filtro_amostras_init(&f, modos[m], 5, 64);
+        for (int i = 0; i < 2 * FILTRO_JANELA_MAX; i++)
+        {
+            alimentar(&f, 1000);
+        }
+        filtro_amostras_reiniciar(&f);
+        VERIFICAR(alimentar(&f, 3000) == 3000);
+        int segunda = alimentar(&f, 3010);
+        VERIFICAR(segunda >= 3000 && segunda <= 3010);
+    }
+
+    // Sem o reinício, as amostras da exposição anterior ainda pesariam.
+    filtro_amostras_t f;
+    filtro_amostras_init(&f, FILTRO_MEDIANA, 5, 64);
+    for (int i = 0; i < 5; i++)
+    {
+        alimentar(&f, 1000);
+    }
+    VERIFICAR(alimentar(&f, 3000) == 1000);
+}
+
+int main(void)
+{
+    teste_ema();
+    teste_mediana();
+    teste_outliers();
+    teste_reinicio();
+
+    printf("filtro_amostras: %s (%d falhas)\n", falhas ? "FALHOU" : "ok", falhas);
+    return falhas != 0;
+}
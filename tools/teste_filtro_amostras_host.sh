@@ -0,0 +1,14 @@
+#!/bin/sh
+# Teste dos filtros de amostras do sensor (filtro_amostras.c) no PC.
+# Uso: tools/teste_filtro_amostras_host.sh
+set -e
+
+raiz=$(cd "$(dirname "$0")/.." && pwd)
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+cc=${CC:-cc}
+
+$cc -O1 -g -Wall -Wextra -I"$raiz" -o "$tmp/teste" \
+    "$raiz/tools/teste_filtro_amostras_host.c" "$raiz/filtro_amostras.c"
+"$tmp/teste"
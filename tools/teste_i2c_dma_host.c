@@ -0,0 +1,274 @@
+// teste_i2c_dma_host.c
+// Testa, no PC, o escalonador de i2c_dma.c com um backend falso: fila de
+// I2C_DMA_TAMANHO_FILA, ordem de início e de conclusão, abort (TX_ABRT),
+// transferências em sequência, barramentos independentes e o equilíbrio das
+// seções críticas. A "IRQ" de conclusão é chamada pelo próprio teste.
+// Compilado e executado por tools/teste_i2c_dma_host.sh.
+#include <stdio.h>
+#include <string.h>
+
+#include "i2c_dma.h"
+
+static int falhas;
+
+#define VERIFICAR(cond)                                                  \
+    do                                                                   \
+    {                                                                    \
+        if (!(cond))                                                     \
+        {                                                                \
+            printf("FALHOU %s:%d: %s\n", __FILE__, __LINE__, #cond);    \
+            falhas++;                                                    \
+        }                                                                \
+    } while (0)
+
+// --- Backend falso ---
+
+static int profundidade_critica;  // Seções críticas abertas agora
+static int maior_profundidade;
+static int inicios_fora_da_critica;
+static uint8_t iniciadas[I2C_DMA_NUM_BARRAMENTOS][32]; // Endereços, na ordem de início
+static int num_iniciadas[I2C_DMA_NUM_BARRAMENTOS];
+static int eventos_aguardados;
+static i2c_dma_status_t status_no_evento = I2C_DMA_OK;
+
+static void falso_iniciar(unsigned barramento, const i2c_dma_transferencia_t *t)
+{
+    if (profundidade_critica == 0)
+    {
+        inicios_fora_da_critica++;
+    }
+    iniciadas[barramento][num_iniciadas[barramento]++] = t->endereco;
+}
+
+static uint32_t falso_entrar_critica(void)
+{
+    profundidade_critica++;
+    if (profundidade_critica > maior_profundidade)
+    {
+        maior_profundidade = profundidade_critica;
+    }
+    return (uint32_t)profundidade_critica;
+}
+
+static void falso_sair_critica(uint32_t estado)
+{
+    VERIFICAR(estado == (uint32_t)profundidade_critica); // Saída na ordem inversa da entrada
+    profundidade_critica--;
+}
+
+// "Dormir até a IRQ": a transferência em andamento no barramento 0 termina.
+static void falso_aguardar_evento(void)
+{
+    eventos_aguardados++;
+    if (i2c_dma_ocupado(0))
+    {
+        i2c_dma_concluir(0, status_no_evento);
+    }
+}
+
+static const i2c_dma_backend_t backend_falso = {
+    .iniciar = falso_iniciar,
+    .entrar_critica = falso_entrar_critica,
+    .sair_critica = falso_sair_critica,
+    .aguardar_evento = falso_aguardar_evento,
+};
+
+static void reiniciar(void)
+{
+    memset(iniciadas, 0, sizeof(iniciadas));
+    memset(num_iniciadas, 0, sizeof(num_iniciadas));
+    eventos_aguardados = 0;
+    status_no_evento = I2C_DMA_OK;
+    i2c_dma_init(&backend_falso);
+}
+
+// --- Callbacks ---
+
+typedef struct
+{
+    i2c_dma_status_t status[32];
+    int quantidade;
+    int chamadas_na_critica;
+} registro_t;
+
+static void registrar(i2c_dma_status_t status, void *ctx)
+{
+    registro_t *r = (registro_t *)ctx;
+    if (profundidade_critica != 0)
+    {
+        r->chamadas_na_critica++;
+    }
+    r->status[r->quantidade++] = status;
+}
+
+static uint8_t buffer_escrita[1] = {0x80};
+
+static i2c_dma_transferencia_t transferencia(uint8_t endereco, registro_t *r)
+{
+    i2c_dma_transferencia_t t = {
+        .endereco = endereco,
+        .escrita = buffer_escrita,
+        .num_escrita = 1,
+        .callback = registrar,
+        .ctx = r,
+    };
+    return t;
+}
+
+// --- Casos ---
+
+// Uma em andamento mais I2C_DMA_TAMANHO_FILA pendentes; a seguinte é recusada.
+static void teste_fila_cheia(void)
+{
+    reiniciar();
+    registro_t r = {0};
+    for (int i = 0; i < 1 + I2C_DMA_TAMANHO_FILA; i++)
+    {
+        i2c_dma_transferencia_t t = transferencia(0x10 + i, &r);
+        VERIFICAR(i2c_dma_enviar(0, &t));
+    }
+    i2c_dma_transferencia_t extra = transferencia(0x7F, &r);
+    VERIFICAR(!i2c_dma_enviar(0, &extra));
+    VERIFICAR(num_iniciadas[0] == 1);
+    VERIFICAR(iniciadas[0][0] == 0x10);
+    VERIFICAR(i2c_dma_ocupado(0));
+
+    // Cada conclusão inicia a próxima, na ordem de chegada, e libera uma vaga.
+    for (int i = 1; i < 1 + I2C_DMA_TAMANHO_FILA; i++)
+    {
+        i2c_dma_concluir(0, I2C_DMA_OK);
+        VERIFICAR(num_iniciadas[0] == i + 1);
+        VERIFICAR(iniciadas[0][i] == 0x10 + i);
+        VERIFICAR(i2c_dma_ocupado(0));
+    }
+    VERIFICAR(i2c_dma_enviar(0, &extra)); // Há vaga de novo
+    i2c_dma_concluir(0, I2C_DMA_OK);
+    VERIFICAR(iniciadas[0][1 + I2C_DMA_TAMANHO_FILA] == 0x7F);
+    i2c_dma_concluir(0, I2C_DMA_OK);
+    VERIFICAR(!i2c_dma_ocupado(0));
+    VERIFICAR(r.quantidade == 2 + I2C_DMA_TAMANHO_FILA);
+    VERIFICAR(r.chamadas_na_critica == 0);
+}
+
+// NACK/perda de arbitragem: o status chega só à transferência abortada e a fila segue.
+static void teste_abort(void)
+{
+    reiniciar();
+    registro_t r = {0};
+    for (int i = 0; i < 3; i++)
+    {
+        i2c_dma_transferencia_t t = transferencia(0x20 + i, &r);
+        VERIFICAR(i2c_dma_enviar(0, &t));
+    }
+    i2c_dma_concluir(0, I2C_DMA_OK);
+    i2c_dma_concluir(0, I2C_DMA_ERRO_ABORTADA);
+    i2c_dma_concluir(0, I2C_DMA_OK);
+    VERIFICAR(r.quantidade == 3);
+    VERIFICAR(r.status[0] == I2C_DMA_OK);
+    VERIFICAR(r.status[1] == I2C_DMA_ERRO_ABORTADA);
+    VERIFICAR(r.status[2] == I2C_DMA_OK);
+    VERIFICAR(num_iniciadas[0] == 3);
+    VERIFICAR(!i2c_dma_ocupado(0));
+
+    // Bloqueante: o abort volta como retorno e também para o callback de quem chamou.
+    registro_t rb = {0};
+    i2c_dma_transferencia_t t = transferencia(0x2A, &rb);
+    status_no_evento = I2C_DMA_ERRO_ABORTADA;
+    VERIFICAR(i2c_dma_transferir(0, &t) == I2C_DMA_ERRO_ABORTADA);
+    VERIFICAR(rb.quantidade == 1 && rb.status[0] == I2C_DMA_ERRO_ABORTADA);
+    VERIFICAR(!i2c_dma_ocupado(0));
+}
+
+// Callback que enfileira a próxima (como o OLED encadeia páginas) a partir da "IRQ".
+static int encadeadas_restantes;
+static registro_t registro_encadeado;
+
+static void encadear(i2c_dma_status_t status, void *ctx)
+{
+    registrar(status, ctx);
+    if (encadeadas_restantes > 0)
+    {
+        encadeadas_restantes--;
+        i2c_dma_transferencia_t t = transferencia(0x40, &registro_encadeado);
+        t.callback = encadear;
+        VERIFICAR(i2c_dma_enviar(0, &t));
+    }
+}
+
+static void teste_sequencia(void)
+{
+    reiniciar();
+    memset(&registro_encadeado, 0, sizeof(registro_encadeado));
+    encadeadas_restantes = 9;
+    i2c_dma_transferencia_t t = transferencia(0x40, &registro_encadeado);
+    t.callback = encadear;
+    VERIFICAR(i2c_dma_enviar(0, &t));
+    for (int i = 0; i < 10; i++)
+    {
+        VERIFICAR(i2c_dma_ocupado(0));
+        i2c_dma_concluir(0, I2C_DMA_OK);
+    }
+    VERIFICAR(!i2c_dma_ocupado(0));
+    VERIFICAR(num_iniciadas[0] == 10);
+    VERIFICAR(registro_encadeado.quantidade == 10);
+    VERIFICAR(registro_encadeado.chamadas_na_critica == 0);
+
+    // Bloqueantes em sequência com a fila já cheia: cada uma espera vaga e depois o fim.
+    reiniciar();
+    registro_t r = {0};
+    for (int i = 0; i < 1 + I2C_DMA_TAMANHO_FILA; i++)
+    {
+        i2c_dma_transferencia_t c = transferencia(0x50 + i, &r);
+        VERIFICAR(i2c_dma_enviar(0, &c));
+    }
+    for (int i = 0; i < 3; i++)
+    {
+        i2c_dma_transferencia_t b = transferencia(0x60 + i, &r);
+        VERIFICAR(i2c_dma_transferir(0, &b) == I2C_DMA_OK);
+    }
+    VERIFICAR(!i2c_dma_ocupado(0));
+    VERIFICAR(num_iniciadas[0] == 4 + I2C_DMA_TAMANHO_FILA);
+    VERIFICAR(iniciadas[0][1 + I2C_DMA_TAMANHO_FILA] == 0x60);
+    VERIFICAR(iniciadas[0][3 + I2C_DMA_TAMANHO_FILA] == 0x62);
+    VERIFICAR(r.quantidade == 4 + I2C_DMA_TAMANHO_FILA);
+    VERIFICAR(eventos_aguardados >= 4 + I2C_DMA_TAMANHO_FILA);
+}
+
+// Filas separadas por barramento: concluir um não mexe no outro.
+static void teste_barramentos(void)
+{
+    reiniciar();
+    registro_t r0 = {0}, r1 = {0};
+    for (int i = 0; i < 1 + I2C_DMA_TAMANHO_FILA; i++)
+    {
+        i2c_dma_transferencia_t a = transferencia(0x30 + i, &r0);
+        i2c_dma_transferencia_t b = transferencia(0x70 + i, &r1);
+        VERIFICAR(i2c_dma_enviar(0, &a));
+        VERIFICAR(i2c_dma_enviar(1, &b));
+    }
+    VERIFICAR(num_iniciadas[0] == 1 && num_iniciadas[1] == 1);
+    i2c_dma_concluir(1, I2C_DMA_OK);
+    VERIFICAR(num_iniciadas[0] == 1 && num_iniciadas[1] == 2);
+    VERIFICAR(iniciadas[1][1] == 0x71);
+    VERIFICAR(r0.quantidade == 0 && r1.quantidade == 1);
+    while (i2c_dma_ocupado(1))
+    {
+        i2c_dma_concluir(1, I2C_DMA_OK);
+    }
+    VERIFICAR(i2c_dma_ocupado(0));
+    VERIFICAR(r1.quantidade == 1 + I2C_DMA_TAMANHO_FILA);
+}
+
+int main(void)
+{
+    teste_fila_cheia();
+    teste_abort();
+    teste_sequencia();
+    teste_barramentos();
+
+    VERIFICAR(inicios_fora_da_critica == 0);
+    VERIFICAR(profundidade_critica == 0);
+    printf("i2c_dma: %s (%d falhas, seção crítica no máximo %d nível)\n", falhas ? "FALHOU" : "ok", falhas,
+           maior_profundidade);
+    return falhas != 0;
+}
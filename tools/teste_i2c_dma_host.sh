@@ -0,0 +1,14 @@
+#!/bin/sh
+# Teste do escalonador I2C assíncrono (i2c_dma.c) no PC, com um backend falso.
+# Uso: tools/teste_i2c_dma_host.sh
+set -e
+
+raiz=$(cd "$(dirname "$0")/.." && pwd)
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+cc=${CC:-cc}
+
+$cc -O1 -g -Wall -Wextra -I"$raiz" -o "$tmp/teste" \
+    "$raiz/tools/teste_i2c_dma_host.c" "$raiz/i2c_dma.c"
+"$tmp/teste"
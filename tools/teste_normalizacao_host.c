@@ -0,0 +1,118 @@
+// teste_normalizacao_host.c
+// Compara, no PC, a normalização em Q16 de controle_exposicao.c com a referência
+// em float (255 * canal / clear), em todas as contagens de 16 bits e em clears
+// de 1 a 65535 (os extremos, as potências de 2 e uma amostra pseudoaleatória):
+// a diferença não pode passar de 1 LSB.
+// Compilado e executado por tools/teste_normalizacao_host.sh.
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "controle_exposicao.h"
+
+#define CLEARS_ALEATORIOS 64
+
+static int falhas;
+
+// Referência: proporção do clear, truncada, saturada em 255.
+static uint8_t normalizar_float(uint16_t bruto, uint16_t clear)
+{
+    return (uint8_t)fminf(255.0f, (float)bruto / clear * 255.0f);
+}
+
+static uint8_t normalizar_q16(uint16_t bruto, uint16_t clear)
+{
+    uint8_t r, g, b;
+    controle_exposicao_normalizar_rgb(bruto, bruto, bruto, clear, &r, &g, &b);
+    if (r != g || r != b)
+    {
+        printf("FALHOU canais diferentes: bruto %u, clear %u\n", bruto, clear);
+        falhas++;
+    }
+    return r;
+}
+
+static int maior_erro;
+static long diferentes;
+static long entradas;
+
+static void conferir_clear(uint16_t clear)
+{
+    for (uint32_t bruto = 0; bruto <= UINT16_MAX; bruto++)
+    {
+        int erro = abs(normalizar_q16((uint16_t)bruto, clear) - normalizar_float((uint16_t)bruto, clear));
+        if (erro > 1)
+        {
+            printf("FALHOU bruto %lu, clear %u: erro %d LSB\n", (unsigned long)bruto, clear, erro);
+            falhas++;
+        }
+        diferentes += erro != 0;
+        if (erro > maior_erro)
+        {
+            maior_erro = erro;
+        }
+        entradas++;
+    }
+}
+
+static void teste_contra_float(void)
+{
+    for (uint32_t clear = 1; clear <= 0x8000; clear <<= 1)
+    {
+        conferir_clear((uint16_t)clear);
+        conferir_clear((uint16_t)(clear * 2 - 1));
+    }
+    conferir_clear(3);
+    conferir_clear(1000);
+    srand(1);
+    for (int i = 0; i < CLEARS_ALEATORIOS; i++)
+    {
+        conferir_clear((uint16_t)(1 + rand() % UINT16_MAX));
+    }
+    printf("  Q16 x float: erro maximo %d LSB, %ld de %ld entradas diferentes\n", maior_erro, diferentes,
+           entradas);
+}
+
+// A proporção não depende da exposição: as mesmas contagens multiplicadas por um
+// ganho ou tempo maior dão a mesma saída (a menos do truncamento).
+static void teste_exposicao(void)
+{
+    static const uint16_t canais[3] = {300, 520, 410};
+    static const uint16_t clear = 1400;
+    static const uint8_t multiplicadores[] = {1, 4, 16, 40};
+    uint8_t base[3];
+    controle_exposicao_normalizar_rgb(canais[0], canais[1], canais[2], clear, &base[0], &base[1], &base[2]);
+    for (unsigned m = 0; m < sizeof(multiplicadores); m++)
+    {
+        uint16_t k = multiplicadores[m];
+        uint8_t saida[3];
+        controle_exposicao_normalizar_rgb(canais[0] * k, canais[1] * k, canais[2] * k, clear * k, &saida[0],
+                                          &saida[1], &saida[2]);
+        for (int c = 0; c < 3; c++)
+        {
+            if (abs(saida[c] - base[c]) > 1)
+            {
+                printf("FALHOU exposicao x%u, canal %d: %u, esperado %u\n", k, c, saida[c], base[c]);
+                falhas++;
+            }
+        }
+    }
+
+    // Clear zero (sensor sem luz nenhuma) dá preto, sem dividir por zero.
+    uint8_t r, g, b;
+    controle_exposicao_normalizar_rgb(10, 20, 30, 0, &r, &g, &b);
+    if (r || g || b)
+    {
+        printf("FALHOU clear zero: %u %u %u\n", r, g, b);
+        falhas++;
+    }
+}
+
+int main(void)
+{
+    teste_contra_float();
+    teste_exposicao();
+
+    printf("normalizacao: %s (%d falhas)\n", falhas ? "FALHOU" : "ok", falhas);
+    return falhas != 0;
+}
@@ -0,0 +1,14 @@
+#!/bin/sh
+# Teste da normalização em ponto fixo (controle_exposicao.c) contra a referência em float, no PC.
+# Uso: tools/teste_normalizacao_host.sh
+set -e
+
+raiz=$(cd "$(dirname "$0")/.." && pwd)
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+cc=${CC:-cc}
+
+$cc -O1 -g -Wall -Wextra -I"$raiz" -o "$tmp/teste" \
+    "$raiz/tools/teste_normalizacao_host.c" "$raiz/controle_exposicao.c" -lm
+"$tmp/teste"
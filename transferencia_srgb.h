@@ -0,0 +1,40 @@
+// transferencia_srgb.h
+// Funções de transferência do sRGB por tabela (geradas no build por
+// tools/gerar_tabelas_filtros.py), no lugar de powf(…, 2.4f) e powf(…, 1/2.4f).
+// Valores lineares em Q12: 0 = preto, TRANSFERENCIA_LINEAR_UM = branco.
+#ifndef TRANSFERENCIA_SRGB_H
+#define TRANSFERENCIA_SRGB_H
+
+#include <stdint.h>
+#include "tabelas_filtros.h"
+
+#define TRANSFERENCIA_LINEAR_BITS TABELAS_FILTROS_LINEAR_BITS
+#define TRANSFERENCIA_LINEAR_UM TABELAS_FILTROS_LINEAR_UM
+
+/**
+ * @brief sRGB (0-255) para linear em Q12. Erro máximo de meio LSB.
+ */
+static inline int32_t srgb_para_linear_q12(uint8_t v)
+{
+    return tabela_srgb_linear[v];
+}
+
+/**
+ * @brief Linear em Q12 para sRGB (0-255), com saturação fora de [0, 1].
+ *
+ * Uma entrada por valor Q12: valores vindos de srgb_para_linear_q12() voltam exatos.
+ */
+static inline uint8_t linear_q12_para_srgb(int32_t v)
+{
+    if (v <= 0)
+    {
+        return 0;
+    }
+    if (v >= TRANSFERENCIA_LINEAR_UM)
+    {
+        return 255;
+    }
+    return tabela_linear_srgb[v];
+}
+
+#endif // TRANSFERENCIA_SRGB_H
@@ -0,0 +1,144 @@
+// Página do Colorviz: estado inicial de /api/cor, atualizações por /events (SSE)
+// e o histórico de /api/historico. Tudo pela mesma conexão keep-alive quando possível.
+'use strict';
+
+var INTERVALO_HISTORICO_MS = 2000;
+
+function $(id) {
+  return document.getElementById(id);
+}
+
+function rgb(c) {
+  return 'rgb(' + c.join(',') + ')';
+}
+
+function aviso(texto) {
+  $('conexao').textContent = texto;
+}
+
+function pedirJson(caminho) {
+  return fetch(caminho, {cache: 'no-store'}).then(function (r) {
+    if (!r.ok) {
+      throw new Error(caminho + ': ' + r.status);
+    }
+    return r.json();
+  });
+}
+
+// Um cartão por modo: a cor simulada em cima, a corrigida embaixo (não há para Normal).
+function desenharModos(modos) {
+  var grade = $('modos');
+  while (grade.children.length > modos.length) {
+    grade.removeChild(grade.lastChild);
+  }
+  modos.forEach(function (m, i) {
+    var cartao = grade.children[i];
+    if (!cartao) {
+      cartao = document.createElement('div');
+      cartao.className = 'modo';
+      cartao.innerHTML = '<div></div><div></div><p></p>';
+      grade.appendChild(cartao);
+    }
+    cartao.children[0].style.background = rgb(m.rgb);
+    cartao.children[1].style.background = i ? rgb(m.corrigida) : rgb(m.rgb);
+    cartao.children[1].title = i ? 'Corrigida' : '';
+    cartao.children[2].textContent = m.modo;
+  });
+}
+
+function mostrarCor(estado) {
+  var lida = estado.sequencia !== 0 && estado.candidatas.length > 0;
+  document.body.style.backgroundColor = rgb(estado.rgb);
+  $('amostra').style.background = rgb(estado.rgb);
+  $('nome').textContent = lida ? estado.candidatas[0].nome : 'Aguardando leitura...';
+  $('rgb').textContent = estado.rgb.join(', ');
+  $('modo').textContent = estado.modo;
+  $('sev').textContent = estado.severidade;
+  $('confianca').textContent = lida ? estado.confianca : '-';
+  if (document.activeElement !== $('severidade')) {
+    $('severidade').value = estado.severidade;
+    $('severidade-valor').textContent = estado.severidade + '%';
+  }
+  desenharModos(estado.modos);
+
+  var lista = $('candidatas');
+  lista.textContent = '';
+  estado.candidatas.forEach(function (c) {
+    var item = document.createElement('li');
+    item.textContent = c.nome + ' (ΔE ' + c.distancia + ')';
+    lista.appendChild(item);
+  });
+}
+
+function carregarCor() {
+  return pedirJson('/api/cor').then(mostrarCor).catch(function (e) {
+    aviso('Falha ao ler a cor: ' + e.message);
+  });
+}
+
+// Faixa com a cor de cada amostra e, por cima, a linha da confiança.
+function desenharHistorico(historico) {
+  var tela = $('grafico');
+  var ctx = tela.getContext('2d');
+  var amostras = historico.amostras;
+  ctx.clearRect(0, 0, tela.width, tela.height);
+  $('perdidas').textContent = historico.perdidas;
+  if (!amostras.length) {
+    return;
+  }
+  var largura = tela.width / amostras.length;
+  var faixa = tela.height / 4;
+  amostras.forEach(function (a, i) {
+    ctx.fillStyle = rgb(a.rgb);
+    ctx.fillRect(i * largura, tela.height - faixa, Math.ceil(largura), faixa);
+  });
+  var altura = tela.height - faixa - 8;
+  ctx.strokeStyle = '#ffb000';
+  ctx.lineWidth = 2;
+  ctx.beginPath();
+  amostras.forEach(function (a, i) {
+    var x = i * largura + largura / 2;
+    var y = 4 + altura * (1 - a.confianca / 100);
+    if (i) {
+      ctx.lineTo(x, y);
+    } else {
+      ctx.moveTo(x, y);
+    }
+  });
+  ctx.stroke();
+}
+
+function carregarHistorico() {
+  pedirJson('/api/historico').then(desenharHistorico).catch(function () {}).then(function () {
+    setTimeout(carregarHistorico, INTERVALO_HISTORICO_MS);
+  });
+}
+
+function iniciarEventos() {
+  if (!window.EventSource) {
+    // Sem SSE: consulta periódica
+    setInterval(carregarCor, 1000);
+    return;
+  }
+  var eventos = new EventSource('/events');
+  eventos.onopen = function () {
+    aviso('');
+  };
+  eventos.onerror = function () {
+    aviso('Sem conexão com o aparelho; tentando de novo...');
+  };
+  // O evento só traz o essencial; as candidatas vêm de /api/cor.
+  eventos.onmessage = carregarCor;
+}
+
+$('severidade').addEventListener('input', function () {
+  $('severidade-valor').textContent = this.value + '%';
+});
+$('severidade').addEventListener('change', function () {
+  pedirJson('/api/severidade?valor=' + this.value).then(mostrarCor).catch(function (e) {
+    aviso('Falha ao mudar a severidade: ' + e.message);
+  });
+});
+
+carregarCor().then(iniciarEventos);
+carregarHistorico();